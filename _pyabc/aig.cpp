@@ -0,0 +1,1111 @@
+#include "aig.h"
+#include "events.h"
+
+#include <base/abc/abc.h>
+#include <base/main/main.h>
+#include <misc/extra/extra.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace pyabc
+{
+
+Vec_Ptr_t* aig_number(Abc_Ntk_t* pNtk)
+{
+    Abc_Obj_t* pObj;
+    int i;
+
+    int var = 1;
+
+    Abc_NtkForEachPi( pNtk, pObj, i )
+    {
+        pObj->iTemp = var++;
+    }
+
+    Abc_NtkForEachLatch( pNtk, pObj, i )
+    {
+        Abc_ObjFanout0(pObj)->iTemp = var++;
+    }
+
+    Vec_Ptr_t* vNodes = Abc_AigDfs( pNtk, 1, 0 );
+
+    Vec_PtrForEachEntry( Abc_Obj_t*, vNodes, pObj, i )
+    {
+        pObj->iTemp = var++;
+    }
+
+    return vNodes;
+}
+
+int aig_fanin_lit(Abc_Obj_t* pObj, int i)
+{
+    Abc_Obj_t* pFanin = Abc_ObjFanin(pObj, i);
+
+    if ( Abc_AigNodeIsConst(pFanin) )
+    {
+        return !Abc_ObjFaninC(pObj, i);
+    }
+
+    return 2 * pFanin->iTemp + Abc_ObjFaninC(pObj, i);
+}
+
+int aig_latch_init(Abc_Obj_t* pLatch)
+{
+    return Abc_LatchIsInit0(pLatch) ? 0 : Abc_LatchIsInit1(pLatch) ? 1 : 2;
+}
+
+void aig_flatten(Abc_Ntk_t* pNtk, aig_flat& aig)
+{
+    Vec_Ptr_t* vNodes = aig_number(pNtk);
+
+    aig.nPis = Abc_NtkPiNum(pNtk);
+    aig.nLatches = Abc_NtkLatchNum(pNtk);
+
+    Abc_Obj_t* pObj;
+    int i;
+
+    Vec_PtrForEachEntry( Abc_Obj_t*, vNodes, pObj, i )
+    {
+        aig.fanin0.push_back( aig_fanin_lit(pObj, 0) );
+        aig.fanin1.push_back( aig_fanin_lit(pObj, 1) );
+    }
+
+    Vec_PtrFree( vNodes );
+
+    Abc_NtkForEachPo( pNtk, pObj, i )
+    {
+        aig.pos.push_back( aig_fanin_lit(pObj, 0) );
+    }
+
+    Abc_NtkForEachLatch( pNtk, pObj, i )
+    {
+        aig.next.push_back( aig_fanin_lit(Abc_ObjFanin0(pObj), 0) );
+        aig.init.push_back( aig_latch_init(pObj) );
+    }
+}
+
+Abc_Ntk_t* aig_build(const aig_arrays& a)
+{
+    if ( a.nPis < 0 || a.nLatches < 0 || a.nAnds < 0 || a.nPos < 0 )
+    {
+        return nullptr;
+    }
+
+    if ( 1LL + a.nPis + a.nLatches + a.nAnds > std::numeric_limits<int>::max() / 2 )
+    {
+        return nullptr;
+    }
+
+    Abc_Ntk_t* pNtk = Abc_NtkAlloc( ABC_NTK_STRASH, ABC_FUNC_AIG, 1 );
+    Abc_Aig_t* pMan = static_cast<Abc_Aig_t*>(pNtk->pManFunc);
+
+    int nVars = 1 + a.nPis + a.nLatches + a.nAnds;
+
+    std::vector<Abc_Obj_t*> vars;
+    vars.reserve(nVars);
+
+    vars.push_back( Abc_ObjNot(Abc_AigConst1(pNtk)) );
+
+    for ( int i = 0 ; i < a.nPis ; i++ )
+    {
+        vars.push_back( Abc_NtkCreatePi(pNtk) );
+    }
+
+    std::vector<Abc_Obj_t*> bis;
+    bis.reserve(a.nLatches);
+
+    for ( int i = 0 ; i < a.nLatches ; i++ )
+    {
+        Abc_Obj_t* pLatch = Abc_NtkCreateLatch(pNtk);
+        Abc_Obj_t* pBi = Abc_NtkCreateBi(pNtk);
+        Abc_Obj_t* pBo = Abc_NtkCreateBo(pNtk);
+
+        Abc_ObjAddFanin( pLatch, pBi );
+        Abc_ObjAddFanin( pBo, pLatch );
+
+        int init = a.init ? a.init[i] : 0;
+
+        if ( init == 0 )
+        {
+            Abc_LatchSetInit0( pLatch );
+        }
+        else if ( init == 1 )
+        {
+            Abc_LatchSetInit1( pLatch );
+        }
+        else
+        {
+            Abc_LatchSetInitDc( pLatch );
+        }
+
+        bis.push_back( pBi );
+        vars.push_back( pBo );
+    }
+
+    // a literal may only refer to variables that are already defined
+    auto lit = [&](std::int32_t l) -> Abc_Obj_t*
+    {
+        if ( l < 0 || (l >> 1) >= static_cast<std::int32_t>(vars.size()) )
+        {
+            return nullptr;
+        }
+
+        return Abc_ObjNotCond( vars[l >> 1], l & 1 );
+    };
+
+    for ( int i = 0 ; i < a.nAnds ; i++ )
+    {
+        Abc_Obj_t* p0 = lit(a.fanin0[i]);
+        Abc_Obj_t* p1 = lit(a.fanin1[i]);
+
+        if ( !p0 || !p1 )
+        {
+            Abc_NtkDelete(pNtk);
+            return nullptr;
+        }
+
+        vars.push_back( Abc_AigAnd(pMan, p0, p1) );
+    }
+
+    for ( int i = 0 ; i < a.nPos ; i++ )
+    {
+        Abc_Obj_t* pDriver = lit(a.pos[i]);
+
+        if ( !pDriver )
+        {
+            Abc_NtkDelete(pNtk);
+            return nullptr;
+        }
+
+        Abc_ObjAddFanin( Abc_NtkCreatePo(pNtk), pDriver );
+    }
+
+    for ( int i = 0 ; i < a.nLatches ; i++ )
+    {
+        Abc_Obj_t* pDriver = lit(a.next[i]);
+
+        if ( !pDriver )
+        {
+            Abc_NtkDelete(pNtk);
+            return nullptr;
+        }
+
+        Abc_ObjAddFanin( bis[i], pDriver );
+    }
+
+    pNtk->pName = Extra_UtilStrsav( a.name ? a.name : "aig" );
+
+    auto assign_name = [](Abc_Obj_t* pObj, const char* const* names, int i, const char* suffix)
+    {
+        const char* name = names ? names[i] : nullptr;
+        Abc_ObjAssignName( pObj, name ? const_cast<char*>(name) : Abc_ObjName(pObj), const_cast<char*>(suffix) );
+    };
+
+    Abc_Obj_t* pObj;
+    int i;
+
+    Abc_NtkForEachPi( pNtk, pObj, i )
+    {
+        assign_name( pObj, a.pi_names, i, nullptr );
+    }
+
+    Abc_NtkForEachPo( pNtk, pObj, i )
+    {
+        assign_name( pObj, a.po_names, i, nullptr );
+    }
+
+    Abc_NtkForEachLatch( pNtk, pObj, i )
+    {
+        assign_name( Abc_ObjFanout0(pObj), a.latch_names, i, nullptr );
+
+        const char* name = Abc_ObjName( Abc_ObjFanout0(pObj) );
+        Abc_ObjAssignName( Abc_ObjFanin0(pObj), const_cast<char*>(name), const_cast<char*>("_in") );
+        Abc_ObjAssignName( pObj, const_cast<char*>(name), const_cast<char*>("_latch") );
+    }
+
+    if ( !Abc_NtkCheck(pNtk) )
+    {
+        Abc_NtkDelete(pNtk);
+        return nullptr;
+    }
+
+    return pNtk;
+}
+
+namespace
+{
+
+void put_uint(std::string& buf, unsigned x)
+{
+    buf.append( std::to_string(x) );
+}
+
+void put_delta(std::string& buf, unsigned x)
+{
+    while ( x & ~0x7fu )
+    {
+        buf.push_back( static_cast<char>((x & 0x7f) | 0x80) );
+        x >>= 7;
+    }
+
+    buf.push_back( static_cast<char>(x) );
+}
+
+void write_strashed(Abc_Ntk_t* pNtk, std::string& buf, bool fSymbols)
+{
+    Vec_Ptr_t* vNodes = aig_number(pNtk);
+
+    int nPis = Abc_NtkPiNum(pNtk);
+    int nLatches = Abc_NtkLatchNum(pNtk);
+    int nAnds = Vec_PtrSize(vNodes);
+
+    buf.reserve( buf.size() + 64 + 4 * nAnds + 8 * (nLatches + Abc_NtkPoNum(pNtk)) );
+
+    buf.append( "aig " );
+    put_uint( buf, nPis + nLatches + nAnds );
+    buf.push_back( ' ' );
+    put_uint( buf, nPis );
+    buf.push_back( ' ' );
+    put_uint( buf, nLatches );
+    buf.push_back( ' ' );
+    put_uint( buf, Abc_NtkPoNum(pNtk) );
+    buf.push_back( ' ' );
+    put_uint( buf, nAnds );
+    buf.push_back( '\n' );
+
+    Abc_Obj_t* pObj;
+    int i;
+
+    Abc_NtkForEachLatch( pNtk, pObj, i )
+    {
+        put_uint( buf, aig_fanin_lit(Abc_ObjFanin0(pObj), 0) );
+
+        int init = aig_latch_init(pObj);
+
+        if ( init == 1 )
+        {
+            buf.append( " 1" );
+        }
+        else if ( init == 2 )
+        {
+            buf.push_back( ' ' );
+            put_uint( buf, 2 * Abc_ObjFanout0(pObj)->iTemp );
+        }
+
+        buf.push_back( '\n' );
+    }
+
+    Abc_NtkForEachPo( pNtk, pObj, i )
+    {
+        put_uint( buf, aig_fanin_lit(pObj, 0) );
+        buf.push_back( '\n' );
+    }
+
+    Vec_PtrForEachEntry( Abc_Obj_t*, vNodes, pObj, i )
+    {
+        unsigned lhs = 2 * pObj->iTemp;
+        unsigned rhs0 = aig_fanin_lit(pObj, 0);
+        unsigned rhs1 = aig_fanin_lit(pObj, 1);
+
+        if ( rhs0 < rhs1 )
+        {
+            std::swap( rhs0, rhs1 );
+        }
+
+        put_delta( buf, lhs - rhs0 );
+        put_delta( buf, rhs0 - rhs1 );
+    }
+
+    Vec_PtrFree( vNodes );
+
+    if ( fSymbols )
+    {
+        auto put_symbol = [&](char type, int i, Abc_Obj_t* pObj)
+        {
+            buf.push_back( type );
+            put_uint( buf, i );
+            buf.push_back( ' ' );
+            buf.append( Abc_ObjName(pObj) );
+            buf.push_back( '\n' );
+        };
+
+        Abc_NtkForEachPi( pNtk, pObj, i )
+        {
+            put_symbol( 'i', i, pObj );
+        }
+
+        Abc_NtkForEachLatch( pNtk, pObj, i )
+        {
+            put_symbol( 'l', i, Abc_ObjFanout0(pObj) );
+        }
+
+        Abc_NtkForEachPo( pNtk, pObj, i )
+        {
+            put_symbol( 'o', i, pObj );
+        }
+    }
+
+    // the network name goes into the comment section, as ABC's write_aiger does it
+    buf.append( "c\n" );
+
+    if ( pNtk->pName && *pNtk->pName )
+    {
+        buf.append( ".model " );
+        buf.append( pNtk->pName );
+        buf.push_back( '\n' );
+    }
+}
+
+// parses binary AIGER directly from memory
+class aiger_parser
+{
+public:
+
+    aiger_parser(const char* data, std::size_t size) :
+        _p(data),
+        _end(data + size)
+    {
+    }
+
+    bool at_end() const
+    {
+        return _p == _end;
+    }
+
+    bool peek(char c) const
+    {
+        return _p != _end && *_p == c;
+    }
+
+    bool expect(char c)
+    {
+        if ( !peek(c) )
+        {
+            return false;
+        }
+
+        ++_p;
+        return true;
+    }
+
+    bool expect(const char* s)
+    {
+        while ( *s )
+        {
+            if ( !expect(*s++) )
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool uint(unsigned& x)
+    {
+        if ( _p == _end || *_p < '0' || *_p > '9' )
+        {
+            return false;
+        }
+
+        std::uint64_t v = 0;
+
+        while ( _p != _end && *_p >= '0' && *_p <= '9' )
+        {
+            v = v * 10 + (*_p++ - '0');
+
+            if ( v > 0x7fffffff )
+            {
+                return false;
+            }
+        }
+
+        x = v;
+        return true;
+    }
+
+    bool delta(unsigned& x)
+    {
+        std::uint64_t v = 0;
+
+        for ( int shift = 0 ; _p != _end && shift < 35 ; shift += 7 )
+        {
+            unsigned char c = *_p++;
+            v |= std::uint64_t(c & 0x7f) << shift;
+
+            if ( !(c & 0x80) )
+            {
+                if ( v > 0x7fffffff )
+                {
+                    return false;
+                }
+
+                x = v;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool line(std::string& s)
+    {
+        const char* eol = static_cast<const char*>( memchr(_p, '\n', _end - _p) );
+
+        if ( !eol )
+        {
+            return false;
+        }
+
+        s.assign( _p, eol );
+        _p = eol + 1;
+
+        return true;
+    }
+
+    std::size_t remaining() const
+    {
+        return _end - _p;
+    }
+
+private:
+
+    const char* _p;
+    const char* _end;
+};
+
+} // unnamed namespace
+
+bool aiger_write(Abc_Ntk_t* pNtk, std::string& buf, bool fSymbols)
+{
+    if ( Abc_NtkIsStrash(pNtk) )
+    {
+        write_strashed( pNtk, buf, fSymbols );
+        return true;
+    }
+
+    Abc_Ntk_t* pStrashed = Abc_NtkStrash( pNtk, 0, 1, 0 );
+
+    if ( !pStrashed )
+    {
+        return false;
+    }
+
+    write_strashed( pStrashed, buf, fSymbols );
+    Abc_NtkDelete( pStrashed );
+
+    return true;
+}
+
+Abc_Ntk_t* aiger_read(const char* data, std::size_t size)
+{
+    aiger_parser p(data, size);
+
+    unsigned M, I, L, O, A;
+
+    if ( !p.expect("aig ") || !p.uint(M) || !p.expect(' ') || !p.uint(I) || !p.expect(' ') || !p.uint(L) || !p.expect(' ') || !p.uint(O) || !p.expect(' ') || !p.uint(A) )
+    {
+        return nullptr;
+    }
+
+    // optional B C J F counts, only bad-state properties are supported
+    unsigned extra[4] = { 0, 0, 0, 0 };
+
+    for ( int i = 0 ; i < 4 && p.expect(' ') ; i++ )
+    {
+        if ( !p.uint(extra[i]) )
+        {
+            return nullptr;
+        }
+    }
+
+    unsigned B = extra[0];
+
+    if ( !p.expect('\n') || extra[1] || extra[2] || extra[3] || std::uint64_t(I) + L + A != M )
+    {
+        return nullptr;
+    }
+
+    // every latch, output and AND takes at least two bytes, reject sizes that cannot fit before allocating
+    if ( 2 * (std::uint64_t(L) + O + B + A) > p.remaining() )
+    {
+        return nullptr;
+    }
+
+    std::vector<std::int32_t> next(L);
+    std::vector<std::int32_t> init(L);
+
+    for ( unsigned i = 0 ; i < L ; i++ )
+    {
+        unsigned lit;
+        unsigned reset = 0;
+
+        if ( !p.uint(lit) || ( p.expect(' ') && !p.uint(reset) ) || !p.expect('\n') )
+        {
+            return nullptr;
+        }
+
+        next[i] = lit;
+
+        if ( reset == 0 || reset == 1 )
+        {
+            init[i] = reset;
+        }
+        else if ( reset == 2 * (I + i + 1) )
+        {
+            init[i] = 2;
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+    std::vector<std::int32_t> pos(O + B);
+
+    for ( unsigned i = 0 ; i < O + B ; i++ )
+    {
+        unsigned lit;
+
+        if ( !p.uint(lit) || !p.expect('\n') )
+        {
+            return nullptr;
+        }
+
+        pos[i] = lit;
+    }
+
+    std::vector<std::int32_t> fanin0(A);
+    std::vector<std::int32_t> fanin1(A);
+
+    for ( unsigned i = 0 ; i < A ; i++ )
+    {
+        unsigned lhs = 2 * (I + L + i + 1);
+        unsigned d0, d1;
+
+        if ( !p.delta(d0) || !p.delta(d1) || d0 == 0 || d0 > lhs || d1 > lhs - d0 )
+        {
+            return nullptr;
+        }
+
+        fanin0[i] = lhs - d0;
+        fanin1[i] = lhs - d0 - d1;
+    }
+
+    // symbol table and comments
+    std::vector<std::string> pi_names(I);
+    std::vector<std::string> po_names(O + B);
+    std::vector<std::string> latch_names(L);
+    std::string name;
+
+    std::string line;
+
+    while ( !p.at_end() )
+    {
+        if ( p.expect('c') )
+        {
+            while ( p.line(line) )
+            {
+                if ( line.compare(0, 7, ".model ") == 0 )
+                {
+                    name = line.substr(7);
+                    break;
+                }
+            }
+
+            break;
+        }
+
+        char type = p.peek('i') ? 'i' : p.peek('l') ? 'l' : p.peek('o') ? 'o' : p.peek('b') ? 'b' : 0;
+        unsigned index;
+
+        if ( !type || !p.expect(type) || !p.uint(index) || !p.expect(' ') || !p.line(line) )
+        {
+            return nullptr;
+        }
+
+        std::vector<std::string>& names = type == 'i' ? pi_names : type == 'l' ? latch_names : po_names;
+
+        if ( type == 'b' )
+        {
+            index += O;
+        }
+
+        if ( index >= names.size() || ( type == 'o' && index >= O ) )
+        {
+            return nullptr;
+        }
+
+        names[index] = line;
+    }
+
+    auto name_ptrs = [](const std::vector<std::string>& names)
+    {
+        std::vector<const char*> ptrs;
+
+        for ( const std::string& s : names )
+        {
+            ptrs.push_back( s.empty() ? nullptr : s.c_str() );
+        }
+
+        return ptrs;
+    };
+
+    std::vector<const char*> pi_ptrs = name_ptrs(pi_names);
+    std::vector<const char*> po_ptrs = name_ptrs(po_names);
+    std::vector<const char*> latch_ptrs = name_ptrs(latch_names);
+
+    aig_arrays a = {};
+
+    a.nPis = I;
+    a.nLatches = L;
+    a.nAnds = A;
+    a.nPos = O + B;
+
+    a.fanin0 = fanin0.data();
+    a.fanin1 = fanin1.data();
+    a.pos = pos.data();
+    a.next = next.data();
+    a.init = init.data();
+
+    a.name = name.empty() ? nullptr : name.c_str();
+    a.pi_names = pi_ptrs.data();
+    a.po_names = po_ptrs.data();
+    a.latch_names = latch_ptrs.data();
+
+    return aig_build(a);
+}
+
+namespace
+{
+
+// a new string of n 32-bit integers, to be filled in place
+ref<PyObject> int32_string(std::size_t n, std::int32_t*& p)
+{
+    ref<PyObject> s = String_FromStringAndSize(nullptr, n * sizeof(std::int32_t));
+    p = reinterpret_cast<std::int32_t*>( String_AsString(s) );
+    return s;
+}
+
+// a read-only view of an object that supports the buffer interface (str, bytearray, array.array, numpy arrays, mmap).
+// Objects with the new buffer protocol are locked for as long as the view exists, so a bytearray cannot be resized
+// under it, and can be read with the GIL released. The others (mmap and array.array in Python 2) only lend a pointer
+// until their next change, which is read in place and only valid while the GIL is held.
+class read_buffer
+{
+public:
+
+    // an empty view for nullptr
+    explicit read_buffer(PyObject* o) :
+        _held(false),
+        _data(nullptr),
+        _size(0)
+    {
+        if ( !o )
+        {
+            return;
+        }
+
+        if ( PyObject_CheckBuffer(o) )
+        {
+            if ( PyObject_GetBuffer(o, &_view, PyBUF_SIMPLE) < 0 )
+            {
+                throw exception();
+            }
+
+            _held = true;
+            _data = static_cast<const char*>(_view.buf);
+            _size = _view.len;
+
+            return;
+        }
+
+        const void* p;
+        Py_ssize_t size;
+
+        if ( PyObject_AsReadBuffer(o, &p, &size) < 0 )
+        {
+            throw exception();
+        }
+
+        _data = static_cast<const char*>(p);
+        _size = size;
+    }
+
+    ~read_buffer()
+    {
+        if ( _held )
+        {
+            PyBuffer_Release(&_view);
+        }
+    }
+
+    const char* data() const
+    {
+        return _data;
+    }
+
+    std::size_t size() const
+    {
+        return _size;
+    }
+
+    // whether the object is locked by the view, so it can be read without the GIL
+    bool locked() const
+    {
+        return _held;
+    }
+
+    read_buffer(const read_buffer&) = delete;
+    read_buffer& operator=(const read_buffer&) = delete;
+
+private:
+
+    Py_buffer _view;
+    bool _held;
+
+    const char* _data;
+    std::size_t _size;
+};
+
+// a format that can be read as 32-bit integers: raw bytes, or native or little-endian C ints
+bool int32_format(const Py_buffer& view)
+{
+    if ( view.itemsize == 1 )
+    {
+        return !view.format || strcmp(view.format, "B") == 0 || strcmp(view.format, "b") == 0 || strcmp(view.format, "c") == 0;
+    }
+
+    if ( view.itemsize != sizeof(std::int32_t) || !view.format )
+    {
+        return false;
+    }
+
+    return strcmp(view.format, "i") == 0 || strcmp(view.format, "=i") == 0 || strcmp(view.format, "<i") == 0;
+}
+
+// the typecode of an array.array (or anything else with a one-letter typecode), 0 for other objects
+char array_typecode(PyObject* o)
+{
+    if ( !PyObject_HasAttrString(o, "typecode") )
+    {
+        return 0;
+    }
+
+    PyObject* tc = PyObject_GetAttrString(o, "typecode");
+
+    if ( !tc )
+    {
+        throw exception();
+    }
+
+    char c = PyString_Check(tc) && PyString_Size(tc) == 1 ? PyString_AsString(tc)[0] : '?';
+    Py_DECREF(tc);
+
+    return c;
+}
+
+// a read-only view of the 32-bit integers in an object: str, bytearray, mmap, an array.array of typecode 'i' or a
+// C-contiguous numpy int32 array. Arrays of any other item type raise TypeError rather than being reinterpreted.
+// Objects with only the old buffer protocol lend their pointer in place, so it is only valid while the GIL is held.
+class int32_buffer
+{
+public:
+
+    // an empty view for nullptr
+    explicit int32_buffer(PyObject* o) :
+        _held(false),
+        _data(nullptr),
+        _size(0)
+    {
+        if ( !o )
+        {
+            return;
+        }
+
+        const void* p;
+        Py_ssize_t size;
+
+        if ( PyObject_CheckBuffer(o) )
+        {
+            if ( PyObject_GetBuffer(o, &_view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) < 0 )
+            {
+                throw exception();
+            }
+
+            _held = true;
+
+            if ( !int32_format(_view) )
+            {
+                PyErr_Format(PyExc_TypeError, "expected a buffer of 32-bit integers, got item size %d and format '%s'", int(_view.itemsize), _view.format ? _view.format : "B");
+                throw exception();
+            }
+
+            p = _view.buf;
+            size = _view.len;
+        }
+        else
+        {
+            char typecode = array_typecode(o);
+
+            if ( typecode && typecode != 'i' )
+            {
+                PyErr_Format(PyExc_TypeError, "expected an array of typecode 'i', got '%c'", typecode);
+                throw exception();
+            }
+
+            if ( PyObject_AsReadBuffer(o, &p, &size) < 0 )
+            {
+                throw exception();
+            }
+        }
+
+        if ( size % sizeof(std::int32_t) )
+        {
+            PyErr_SetString(PyExc_ValueError, "buffer size is not a multiple of 4");
+            throw exception();
+        }
+
+        if ( size / sizeof(std::int32_t) > static_cast<std::size_t>( std::numeric_limits<int>::max() ) )
+        {
+            PyErr_SetString(PyExc_ValueError, "buffer is too large");
+            throw exception();
+        }
+
+        _data = static_cast<const std::int32_t*>(p);
+        _size = size / sizeof(std::int32_t);
+    }
+
+    ~int32_buffer()
+    {
+        if ( _held )
+        {
+            PyBuffer_Release(&_view);
+        }
+    }
+
+    const std::int32_t* data() const
+    {
+        return _data;
+    }
+
+    int size() const
+    {
+        return _size;
+    }
+
+    int32_buffer(const int32_buffer&) = delete;
+    int32_buffer& operator=(const int32_buffer&) = delete;
+
+private:
+
+    Py_buffer _view;
+    bool _held;
+
+    const std::int32_t* _data;
+    int _size;
+};
+
+void check_size(int n, int expected, const char* msg)
+{
+    if ( n != expected )
+    {
+        PyErr_SetString(PyExc_ValueError, msg);
+        throw exception();
+    }
+}
+
+} // unnamed namespace
+
+ref<PyObject> aig_to_arrays()
+{
+    Abc_Frame_t* pAbc = Abc_FrameGetGlobalFrame();
+    Abc_Ntk_t * pNtk = Abc_FrameReadNtk(pAbc);
+
+    if ( !pNtk || !Abc_NtkIsStrash(pNtk) )
+    {
+        return None;
+    }
+
+    Vec_Ptr_t* vNodes = aig_number(pNtk);
+
+    int nAnds = Vec_PtrSize(vNodes);
+
+    std::int32_t* fanin0;
+    std::int32_t* fanin1;
+    std::int32_t* pos;
+    std::int32_t* next;
+    std::int32_t* init;
+
+    ref<PyObject> pyfanin0 = int32_string(nAnds, fanin0);
+    ref<PyObject> pyfanin1 = int32_string(nAnds, fanin1);
+    ref<PyObject> pypos = int32_string(Abc_NtkPoNum(pNtk), pos);
+    ref<PyObject> pynext = int32_string(Abc_NtkLatchNum(pNtk), next);
+    ref<PyObject> pyinit = int32_string(Abc_NtkLatchNum(pNtk), init);
+
+    Abc_Obj_t* pObj;
+    int i;
+
+    Vec_PtrForEachEntry( Abc_Obj_t*, vNodes, pObj, i )
+    {
+        fanin0[i] = aig_fanin_lit(pObj, 0);
+        fanin1[i] = aig_fanin_lit(pObj, 1);
+    }
+
+    Vec_PtrFree( vNodes );
+
+    Abc_NtkForEachPo( pNtk, pObj, i )
+    {
+        pos[i] = aig_fanin_lit(pObj, 0);
+    }
+
+    Abc_NtkForEachLatch( pNtk, pObj, i )
+    {
+        next[i] = aig_fanin_lit(Abc_ObjFanin0(pObj), 0);
+        init[i] = aig_latch_init(pObj);
+    }
+
+    ref<PyObject> res = Dict_New();
+
+    Dict_SetItemString(res, "n_pis", Int_FromLong(Abc_NtkPiNum(pNtk)));
+    Dict_SetItemString(res, "n_latches", Int_FromLong(Abc_NtkLatchNum(pNtk)));
+    Dict_SetItemString(res, "n_ands", Int_FromLong(nAnds));
+    Dict_SetItemString(res, "fanin0", pyfanin0);
+    Dict_SetItemString(res, "fanin1", pyfanin1);
+    Dict_SetItemString(res, "pos", pypos);
+    Dict_SetItemString(res, "latch_next", pynext);
+    Dict_SetItemString(res, "latch_init", pyinit);
+
+    return res;
+}
+
+ref<PyObject> aig_from_arrays(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "n_pis", "n_latches", "fanin0", "fanin1", "pos", "latch_next", "latch_init", NULL };
+
+    aig_arrays a = {};
+
+    PyObject* pyfanin0 = nullptr;
+    PyObject* pyfanin1 = nullptr;
+    PyObject* pypos = nullptr;
+    PyObject* pynext = nullptr;
+    PyObject* pyinit = nullptr;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "iiOOOO|O:aig_from_arrays", kwlist, &a.nPis, &a.nLatches, &pyfanin0, &pyfanin1, &pypos, &pynext, &pyinit);
+
+    if ( a.nPis < 0 || a.nLatches < 0 )
+    {
+        PyErr_SetString(PyExc_ValueError, "n_pis and n_latches must not be negative");
+        throw exception();
+    }
+
+    int32_buffer fanin0(pyfanin0);
+    int32_buffer fanin1(pyfanin1);
+    int32_buffer pos(pypos);
+    int32_buffer next(pynext);
+    int32_buffer init( pyinit != Py_None ? pyinit : nullptr );
+
+    check_size(fanin1.size(), fanin0.size(), "fanin0 and fanin1 differ in size");
+    check_size(next.size(), a.nLatches, "latch_next must have n_latches entries");
+
+    if ( init.data() )
+    {
+        check_size(init.size(), a.nLatches, "latch_init must have n_latches entries");
+    }
+
+    a.nAnds = fanin0.size();
+    a.nPos = pos.size();
+
+    a.fanin0 = fanin0.data();
+    a.fanin1 = fanin1.data();
+    a.pos = pos.data();
+    a.next = next.data();
+    a.init = init.data();
+
+    Abc_Ntk_t* pNtk = aig_build(a);
+
+    if ( !pNtk )
+    {
+        PyErr_SetString(PyExc_ValueError, "malformed AIG arrays");
+        throw exception();
+    }
+
+    Abc_Frame_t* pAbc = Abc_FrameGetGlobalFrame();
+
+    Abc_FrameReplaceCurrentNetwork( pAbc, pNtk );
+    Abc_FrameClearVerifStatus( pAbc );
+
+    events_network_replaced();
+    events_changed();
+
+    return None;
+}
+
+ref<PyObject> read_aiger_bytes(PyObject* pybuf)
+{
+    read_buffer buf(pybuf);
+
+    Abc_Ntk_t* pNtk;
+
+    if ( buf.locked() )
+    {
+        enable_threads scope;
+        pNtk = aiger_read( buf.data(), buf.size() );
+    }
+    else
+    {
+        pNtk = aiger_read( buf.data(), buf.size() );
+    }
+
+    if ( !pNtk )
+    {
+        return False;
+    }
+
+    Abc_Frame_t* pAbc = Abc_FrameGetGlobalFrame();
+
+    Abc_FrameReplaceCurrentNetwork( pAbc, pNtk );
+    Abc_FrameClearVerifStatus( pAbc );
+
+    events_network_replaced();
+    events_changed();
+
+    return True;
+}
+
+ref<PyObject> write_aiger_bytes(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "symbols", NULL };
+
+    int fSymbols = 1;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "|i:write_aiger_bytes", kwlist, &fSymbols);
+
+    Abc_Ntk_t* pNtk = Abc_FrameReadNtk( Abc_FrameGetGlobalFrame() );
+
+    if ( !pNtk )
+    {
+        return None;
+    }
+
+    std::string buf;
+    bool ok;
+
+    {
+        enable_threads scope;
+        ok = aiger_write( pNtk, buf, fSymbols );
+    }
+
+    if ( !ok )
+    {
+        return None;
+    }
+
+    return String_FromStringAndSize( buf.data(), buf.size() );
+}
+
+} // namespace pyabc
@@ -0,0 +1,94 @@
+#ifndef pyabc_aig__H
+#define pyabc_aig__H
+
+#include "pyabc.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+ABC_NAMESPACE_HEADER_START
+typedef struct Abc_Ntk_t_ Abc_Ntk_t;
+typedef struct Abc_Obj_t_ Abc_Obj_t;
+typedef struct Vec_Ptr_t_ Vec_Ptr_t;
+ABC_NAMESPACE_HEADER_END
+
+namespace pyabc
+{
+
+// AIGER-style numbering of a strashed network: variable 0 is constant false, followed by the PIs,
+// the latch outputs and the AND nodes in topological order. A literal is 2*var + complement.
+// Stores the variable of each CI and AND in its iTemp field, and returns the AND nodes in order.
+Vec_Ptr_t* aig_number(Abc_Ntk_t* pNtk);
+
+// the literal of fanin i of an object numbered by aig_number()
+int aig_fanin_lit(Abc_Obj_t* pObj, int i);
+
+// 0, 1 or 2 for an undefined initial value
+int aig_latch_init(Abc_Obj_t* pLatch);
+
+// a network in flat arrays, using the numbering of aig_number()
+struct aig_arrays
+{
+    int nPis;
+    int nLatches;
+    int nAnds;
+    int nPos;
+
+    const std::int32_t* fanin0;     // nAnds literals
+    const std::int32_t* fanin1;     // nAnds literals
+    const std::int32_t* pos;        // nPos literals
+    const std::int32_t* next;       // nLatches literals
+    const std::int32_t* init;       // nLatches initial values, or nullptr for all 0
+
+    // optional names, individual entries may be nullptr for a default name
+    const char* name;
+    const char* const* pi_names;    // nPis names
+    const char* const* po_names;    // nPos names
+    const char* const* latch_names; // nLatches names
+};
+
+// a copy of a strashed network in the numbering of aig_number(), that can be read by other threads
+// and without the ABC objects. Variables 1..nPis are the PIs, followed by the latch outputs and the ANDs.
+struct aig_flat
+{
+    int nPis = 0;
+    int nLatches = 0;
+
+    std::vector<std::int32_t> fanin0;   // one literal per AND
+    std::vector<std::int32_t> fanin1;
+    std::vector<std::int32_t> pos;
+    std::vector<std::int32_t> next;     // one literal per latch
+    std::vector<std::int32_t> init;
+
+    int n_cis() const
+    {
+        return nPis + nLatches;
+    }
+
+    int n_vars() const
+    {
+        return 1 + n_cis() + fanin0.size();
+    }
+};
+
+void aig_flatten(Abc_Ntk_t* pNtk, aig_flat& aig);
+
+// build a strashed network from flat arrays, return nullptr if the arrays are malformed
+Abc_Ntk_t* aig_build(const aig_arrays& a);
+
+// binary AIGER 1.9 in memory: latches with initial values, bad-state properties are read as POs,
+// the symbol table is optional. A network that is not strashed is strashed before it is written.
+bool aiger_write(Abc_Ntk_t* pNtk, std::string& buf, bool fSymbols);
+Abc_Ntk_t* aiger_read(const char* data, std::size_t size);
+
+ref<PyObject> aig_to_arrays();
+ref<PyObject> aig_from_arrays(PyObject* args, PyObject* kwds);
+
+ref<PyObject> read_aiger_bytes(PyObject* pybuf);
+ref<PyObject> write_aiger_bytes(PyObject* args, PyObject* kwds);
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_aig__H
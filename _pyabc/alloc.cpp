@@ -0,0 +1,141 @@
+#include "alloc.h"
+#include "util.h"
+
+#include <cstdio>
+#include <cstdint>
+
+#include <dlfcn.h>
+#include <malloc.h>
+#include <unistd.h>
+
+namespace pyabc
+{
+
+namespace
+{
+
+typedef int (*mallctl_func)(const char*, void*, std::size_t*, void*, std::size_t);
+
+// jemalloc may be built with or without the je_ prefix
+mallctl_func find_mallctl()
+{
+    static mallctl_func func = []()
+    {
+        void* p = dlsym(RTLD_DEFAULT, "mallctl");
+
+        if ( !p )
+        {
+            p = dlsym(RTLD_DEFAULT, "je_mallctl");
+        }
+
+        return reinterpret_cast<mallctl_func>(p);
+    }();
+
+    return func;
+}
+
+bool read_size(mallctl_func mallctl, const char* name, std::size_t& value)
+{
+    std::size_t size = sizeof(value);
+    return mallctl(name, &value, &size, nullptr, 0) == 0;
+}
+
+// MALLCTL_ARENAS_ALL, to address all arenas at once
+const unsigned jemalloc_all_arenas = 4096;
+
+} // unnamed namespace
+
+bool allocator_trim_heap()
+{
+    if ( mallctl_func mallctl = find_mallctl() )
+    {
+        mallctl("thread.tcache.flush", nullptr, nullptr, nullptr, 0);
+
+        char name[64];
+        snprintf(name, sizeof(name), "arena.%u.purge", jemalloc_all_arenas);
+
+        return mallctl(name, nullptr, nullptr, nullptr, 0) == 0;
+    }
+
+#ifdef __GLIBC__
+    return malloc_trim(0) != 0;
+#else
+    return false;
+#endif
+}
+
+ref<PyObject> allocator_name()
+{
+    return String_FromString( find_mallctl() ? "jemalloc" : "system" );
+}
+
+ref<PyObject> allocator_stats()
+{
+    std::size_t allocated = 0;
+    std::size_t active = 0;
+    std::size_t resident = 0;
+    std::size_t mapped = 0;
+
+    // the memory held by the heap, against which fragmentation is measured
+    std::size_t held = 0;
+
+    if ( mallctl_func mallctl = find_mallctl() )
+    {
+        // the statistics are cached until the epoch is advanced
+
+        std::uint64_t epoch = 1;
+        std::size_t size = sizeof(epoch);
+        mallctl("epoch", &epoch, &size, &epoch, size);
+
+        if ( !read_size(mallctl, "stats.allocated", allocated) || !read_size(mallctl, "stats.active", active) ||
+             !read_size(mallctl, "stats.resident", resident) || !read_size(mallctl, "stats.mapped", mapped) )
+        {
+            return None;
+        }
+
+        held = resident;
+    }
+    else
+    {
+#if defined(__GLIBC__) && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 33 ) )
+        struct mallinfo2 mi = mallinfo2();
+#elif defined(__GLIBC__)
+        struct mallinfo mi = mallinfo();
+#endif
+
+#ifdef __GLIBC__
+        allocated = std::size_t(mi.uordblks) + std::size_t(mi.hblkhd);
+        active = allocated;
+        mapped = std::size_t(mi.arena) + std::size_t(mi.hblkhd);
+#endif
+        resident = rss_bytes();
+        held = mapped;
+    }
+
+    ref<PyObject> res = Dict_New();
+
+    Dict_SetItemString(res, "allocator", allocator_name());
+    Dict_SetItemString(res, "allocated", Int_FromLong(allocated));
+    Dict_SetItemString(res, "active", Int_FromLong(active));
+    Dict_SetItemString(res, "resident", Int_FromLong(resident));
+    Dict_SetItemString(res, "mapped", Int_FromLong(mapped));
+
+    // the fraction of the memory held by the heap that is not in use by live allocations
+    Dict_SetItemString(res, "fragmentation", Float_FromDouble( held > allocated ? 1.0 - double(allocated) / held : 0.0 ));
+
+    return res;
+}
+
+ref<PyObject> allocator_trim()
+{
+    bool ok;
+
+    {
+        enable_threads scope;
+        ok = allocator_trim_heap();
+    }
+
+    return Bool_FromLong(ok);
+}
+
+} // namespace pyabc
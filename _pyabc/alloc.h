@@ -0,0 +1,21 @@
+#ifndef pyabc_alloc__H
+#define pyabc_alloc__H
+
+#include "pyabc.h"
+
+namespace pyabc
+{
+
+// jemalloc is used when it is linked in (PYABC_JEMALLOC) or preloaded, it is detected at runtime.
+// Otherwise these report on and trim the glibc heap.
+
+// return the heap to the system, e.g. before forking, so that children do not inherit freed pages
+bool allocator_trim_heap();
+
+ref<PyObject> allocator_name();
+ref<PyObject> allocator_stats();
+ref<PyObject> allocator_trim();
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_alloc__H
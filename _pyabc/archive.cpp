@@ -0,0 +1,946 @@
+#include "archive.h"
+#include "cex.h"
+#include "fingerprint.h"
+#include "util.h"
+
+#include <base/abc/abc.h>
+#include <base/main/main.h>
+#include <misc/util/utilCex.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pyabc
+{
+
+namespace
+{
+
+// layout: [magic][u32 version][u32 id] followed by records, each a record_header and a payload
+// of header.size bytes padded to a multiple of 8. All fields are native-endian. The id is random,
+// it ties the index to the archive it was written for.
+
+const char archive_magic[8] = { 'P', 'Y', 'A', 'B', 'C', 'C', 'A', '1' };
+const std::uint32_t archive_version = 1;
+
+const std::size_t file_header_size = sizeof(archive_magic) + 2 * sizeof(std::uint32_t);
+const std::size_t archive_id_offset = sizeof(archive_magic) + sizeof(std::uint32_t);
+
+struct record_header
+{
+    std::uint64_t fingerprint_lo;
+    std::uint64_t fingerprint_hi;
+    std::int32_t po;
+    std::int32_t frame;
+    std::uint32_t size;
+    std::uint32_t reserved;
+};
+
+// The index is a sidecar file, <archive>.idx, kept up to date by the writers: an index_header followed
+// by an index_entry for each of the first count records, which end at offset end of the archive. Entries
+// are written before the header that covers them. Opening an archive reads the index, and only scans
+// the records after it, instead of reading every record header.
+
+const char index_magic[8] = { 'P', 'Y', 'A', 'B', 'C', 'C', 'I', '1' };
+const std::uint32_t index_version = 1;
+
+struct index_header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t archive_id;
+    std::uint64_t count;
+    std::uint64_t end;
+};
+
+struct index_entry
+{
+    std::uint64_t fingerprint_lo;
+    std::uint64_t fingerprint_hi;
+    std::int32_t po;
+    std::int32_t frame;
+    std::uint64_t offset;
+    std::uint32_t size;
+    std::uint32_t reserved;
+};
+
+static_assert( sizeof(index_entry) == 40, "the index entries are written as they are laid out" );
+
+std::size_t padded(std::size_t size)
+{
+    return (size + 7) & ~std::size_t(7);
+}
+
+bool pread_all(int fd, void* buf, std::size_t size, std::size_t offset)
+{
+    for ( std::size_t done = 0 ; done < size ; )
+    {
+        ssize_t n = retry_eintr( ::pread, fd, static_cast<char*>(buf) + done, size - done, static_cast<off_t>(offset + done) );
+
+        if ( n <= 0 )
+        {
+            return false;
+        }
+
+        done += n;
+    }
+
+    return true;
+}
+
+bool pwrite_all(int fd, const void* buf, std::size_t size, std::size_t offset)
+{
+    for ( std::size_t done = 0 ; done < size ; )
+    {
+        ssize_t n = retry_eintr( ::pwrite, fd, static_cast<const char*>(buf) + done, size - done, static_cast<off_t>(offset + done) );
+
+        if ( n < 0 )
+        {
+            return false;
+        }
+
+        done += n;
+    }
+
+    return true;
+}
+
+bool parse_fingerprint(const char* hex, hash128& h)
+{
+    if ( strlen(hex) != 32 )
+    {
+        return false;
+    }
+
+    char* end;
+
+    h.hi = strtoull( std::string(hex, 16).c_str(), &end, 16 );
+
+    if ( *end )
+    {
+        return false;
+    }
+
+    h.lo = strtoull( hex + 16, &end, 16 );
+
+    return !*end;
+}
+
+// the fingerprint given as a hex string, or the fingerprint of the current network
+bool fingerprint_arg(const char* hex, hash128& h)
+{
+    if ( hex )
+    {
+        if ( !parse_fingerprint(hex, h) )
+        {
+            PyErr_SetString(PyExc_ValueError, "a fingerprint is a string of 32 hex digits");
+            throw exception();
+        }
+
+        return true;
+    }
+
+    Abc_Ntk_t* pNtk = Abc_FrameReadNtk( Abc_FrameGetGlobalFrame() );
+
+    if ( !pNtk || !Abc_NtkIsStrash(pNtk) )
+    {
+        return false;
+    }
+
+    h = network_fingerprint(pNtk, false);
+
+    return true;
+}
+
+void put_record(std::string& buf, const hash128& h, const Abc_Cex_t* pCex, const Abc_Cex_t* pCare)
+{
+    std::string payload;
+
+    if ( pCare )
+    {
+        cex_write_sparse(pCex, pCare, payload);
+    }
+    else
+    {
+        cex_write(pCex, payload);
+    }
+
+    record_header r = { h.lo, h.hi, pCex->iPo, pCex->iFrame, static_cast<std::uint32_t>(payload.size()), 0 };
+
+    buf.append( reinterpret_cast<const char*>(&r), sizeof(r) );
+    buf.append( payload );
+    buf.append( padded(payload.size()) - payload.size(), '\0' );
+}
+
+} // unnamed namespace
+
+// The methods lock a mutex, as the cex_archive methods that release the GIL may run in several threads.
+// Appends also take an exclusive flock(), to exclude other processes, and refreshes a shared one, so
+// that the file is not truncated under a new mapping.
+class archive_file
+{
+public:
+
+    struct entry
+    {
+        hash128 fingerprint;
+        std::int32_t po;
+        std::int32_t frame;
+        std::size_t offset;     // of the payload
+        std::uint32_t size;
+    };
+
+    static archive_file* open(const char* path, bool writable)
+    {
+        int fd = ::open( path, writable ? O_RDWR | O_CREAT | O_CLOEXEC : O_RDONLY | O_CLOEXEC, 0644 );
+
+        if ( fd < 0 )
+        {
+            return nullptr;
+        }
+
+        archive_file* pFile = new archive_file(fd, path, writable);
+
+        if ( ( writable && !pFile->init() ) || !pFile->refresh() )
+        {
+            delete pFile;
+            return nullptr;
+        }
+
+        return pFile;
+    }
+
+    ~archive_file()
+    {
+        unmap();
+        ::close(_fd);
+    }
+
+    std::size_t size()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _entries.size();
+    }
+
+    entry at(std::size_t i)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _entries[i];
+    }
+
+    Abc_Cex_t* read(std::size_t i, Abc_Cex_t** ppCare)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        const entry& e = _entries[i];
+        return cex_read( _map + e.offset, e.size, ppCare );
+    }
+
+    std::vector<std::size_t> find(const hash128* h, int po, int frame)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::vector<std::size_t> res;
+
+        auto match = [&](std::size_t i)
+        {
+            const entry& e = _entries[i];
+
+            if ( ( po < 0 || e.po == po ) && ( frame < 0 || e.frame == frame ) )
+            {
+                res.push_back(i);
+            }
+        };
+
+        if ( h )
+        {
+            auto it = _by_fingerprint.find( std::make_pair(h->hi, h->lo) );
+
+            if ( it != _by_fingerprint.end() )
+            {
+                for ( std::size_t i : it->second )
+                {
+                    match(i);
+                }
+            }
+        }
+        else
+        {
+            for ( std::size_t i = 0 ; i < _entries.size() ; i++ )
+            {
+                match(i);
+            }
+        }
+
+        return res;
+    }
+
+    // map the records appended since the last refresh, by this process or others
+    bool refresh()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        flock_scope flock(_fd, LOCK_SH);
+
+        return remap();
+    }
+
+    // append serialized records under an exclusive lock, first receives the index of the first one
+    bool append(const std::string& buf, std::size_t& first)
+    {
+        if ( !_writable )
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        flock_scope flock(_fd, LOCK_EX);
+
+        if ( !remap() )
+        {
+            return false;
+        }
+
+        // drop a record cut short by a crash
+        if ( _map_size > _end && ftruncate(_fd, _end) < 0 )
+        {
+            return false;
+        }
+
+        first = _entries.size();
+
+        // a partial record is dropped by the next append
+        if ( !pwrite_all( _fd, buf.data(), buf.size(), _end ) || !remap() )
+        {
+            return false;
+        }
+
+        write_index();
+
+        return true;
+    }
+
+private:
+
+    class flock_scope
+    {
+    public:
+
+        flock_scope(int fd, int op) :
+            _fd(fd)
+        {
+            retry_eintr( ::flock, _fd, op );
+        }
+
+        ~flock_scope()
+        {
+            ::flock( _fd, LOCK_UN );
+        }
+
+    private:
+
+        int _fd;
+    };
+
+    archive_file(int fd, const char* path, bool writable) :
+        _fd(fd),
+        _writable(writable),
+        _index_path(std::string(path) + ".idx")
+    {
+    }
+
+    // write the file header of a new archive
+    bool init()
+    {
+        flock_scope flock(_fd, LOCK_EX);
+
+        struct stat st;
+
+        if ( fstat(_fd, &st) < 0 )
+        {
+            return false;
+        }
+
+        if ( st.st_size > 0 )
+        {
+            return true;
+        }
+
+        char header[file_header_size] = {};
+
+        std::random_device random;
+        std::uint32_t id = random();
+
+        memcpy( header, archive_magic, sizeof(archive_magic) );
+        memcpy( header + sizeof(archive_magic), &archive_version, sizeof(archive_version) );
+        memcpy( header + archive_id_offset, &id, sizeof(id) );
+
+        return pwrite_all( _fd, header, sizeof(header), 0 );
+    }
+
+    // map the file as it is now, and index the records it does not know yet, with the flock held
+    bool remap()
+    {
+        struct stat st;
+
+        if ( fstat(_fd, &st) < 0 )
+        {
+            return false;
+        }
+
+        std::size_t size = st.st_size;
+
+        if ( size < file_header_size )
+        {
+            return false;
+        }
+
+        if ( size != _map_size )
+        {
+            unmap();
+
+            void* p = mmap( nullptr, size, PROT_READ, MAP_SHARED, _fd, 0 );
+
+            if ( p == MAP_FAILED )
+            {
+                return false;
+            }
+
+            _map = static_cast<const char*>(p);
+            _map_size = size;
+        }
+
+        if ( memcmp(_map, archive_magic, sizeof(archive_magic)) != 0 )
+        {
+            return false;
+        }
+
+        if ( _end == 0 )
+        {
+            _end = file_header_size;
+            read_index();
+        }
+
+        scan();
+
+        return true;
+    }
+
+    void unmap()
+    {
+        if ( _map )
+        {
+            munmap( const_cast<char*>(_map), _map_size );
+            _map = nullptr;
+            _map_size = 0;
+        }
+    }
+
+    std::uint32_t archive_id() const
+    {
+        std::uint32_t id;
+        memcpy( &id, _map + archive_id_offset, sizeof(id) );
+        return id;
+    }
+
+    void add_entry(const entry& e)
+    {
+        _by_fingerprint[ std::make_pair(e.fingerprint.hi, e.fingerprint.lo) ].push_back( _entries.size() );
+        _entries.push_back(e);
+    }
+
+    // a header of an index of this archive, that covers records in the mapping
+    bool valid_index_header(const index_header& h) const
+    {
+        return memcmp(h.magic, index_magic, sizeof(index_magic)) == 0 && h.version == index_version && h.archive_id == archive_id() &&
+            h.end >= file_header_size && h.end <= _map_size && h.count <= ( h.end - file_header_size ) / sizeof(record_header);
+    }
+
+    // start from the records in the index, if there is one that matches the archive. The entries must
+    // cover consecutive records, and the last one must match its record header.
+    void read_index()
+    {
+        int fd = ::open( _index_path.c_str(), O_RDONLY | O_CLOEXEC );
+
+        if ( fd < 0 )
+        {
+            return;
+        }
+
+        index_header h;
+        std::vector<index_entry> entries;
+
+        bool ok = pread_all( fd, &h, sizeof(h), 0 ) && valid_index_header(h);
+
+        if ( ok )
+        {
+            entries.resize( h.count );
+            ok = pread_all( fd, entries.data(), entries.size() * sizeof(index_entry), sizeof(h) );
+        }
+
+        ::close(fd);
+
+        std::size_t end = file_header_size;
+
+        for ( std::size_t i = 0 ; ok && i < entries.size() ; i++ )
+        {
+            ok = entries[i].offset == end + sizeof(record_header) && entries[i].offset + padded(entries[i].size) <= h.end;
+            end = entries[i].offset + padded(entries[i].size);
+        }
+
+        if ( !ok || end != h.end )
+        {
+            return;
+        }
+
+        if ( !entries.empty() )
+        {
+            const index_entry& last = entries.back();
+
+            record_header r;
+            memcpy( &r, _map + last.offset - sizeof(r), sizeof(r) );
+
+            if ( r.fingerprint_lo != last.fingerprint_lo || r.fingerprint_hi != last.fingerprint_hi || r.po != last.po || r.frame != last.frame || r.size != last.size )
+            {
+                return;
+            }
+        }
+
+        for ( const index_entry& ie : entries )
+        {
+            entry e;
+
+            e.fingerprint.lo = ie.fingerprint_lo;
+            e.fingerprint.hi = ie.fingerprint_hi;
+            e.po = ie.po;
+            e.frame = ie.frame;
+            e.offset = ie.offset;
+            e.size = ie.size;
+
+            add_entry(e);
+        }
+
+        _end = end;
+    }
+
+    // bring the index up to date with the exclusive flock held: append the entries it lacks, or rewrite
+    // it if it does not match. The index is an optimization, failing to write it is not an error.
+    bool write_index()
+    {
+        int fd = ::open( _index_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644 );
+
+        if ( fd < 0 )
+        {
+            return false;
+        }
+
+        index_header h;
+        std::size_t from = 0;
+
+        if ( pread_all( fd, &h, sizeof(h), 0 ) && valid_index_header(h) && h.count <= _entries.size() )
+        {
+            const entry* pLast = h.count ? &_entries[h.count - 1] : nullptr;
+
+            if ( h.end == ( pLast ? pLast->offset + padded(pLast->size) : file_header_size ) )
+            {
+                from = h.count;
+            }
+        }
+
+        std::vector<index_entry> entries;
+
+        for ( std::size_t i = from ; i < _entries.size() ; i++ )
+        {
+            const entry& e = _entries[i];
+            entries.push_back( index_entry{ e.fingerprint.lo, e.fingerprint.hi, e.po, e.frame, e.offset, e.size, 0 } );
+        }
+
+        memcpy( h.magic, index_magic, sizeof(index_magic) );
+        h.version = index_version;
+        h.archive_id = archive_id();
+        h.count = _entries.size();
+        h.end = _end;
+
+        std::size_t size = sizeof(h) + _entries.size() * sizeof(index_entry);
+
+        bool ok = pwrite_all( fd, entries.data(), entries.size() * sizeof(index_entry), sizeof(h) + from * sizeof(index_entry) ) &&
+            pwrite_all( fd, &h, sizeof(h), 0 ) && ftruncate( fd, size ) == 0;
+
+        ::close(fd);
+
+        return ok;
+    }
+
+    // index the complete records after the last one indexed, reading only their headers
+    void scan()
+    {
+        while ( _map_size - _end >= sizeof(record_header) )
+        {
+            record_header r;
+            memcpy( &r, _map + _end, sizeof(r) );
+
+            std::size_t next = _end + sizeof(r) + padded(r.size);
+
+            if ( next > _map_size )
+            {
+                break;
+            }
+
+            entry e;
+
+            e.fingerprint.lo = r.fingerprint_lo;
+            e.fingerprint.hi = r.fingerprint_hi;
+            e.po = r.po;
+            e.frame = r.frame;
+            e.offset = _end + sizeof(r);
+            e.size = r.size;
+
+            add_entry(e);
+
+            _end = next;
+        }
+    }
+
+    int _fd;
+    bool _writable;
+
+    std::string _index_path;
+
+    std::mutex _mutex;
+
+    const char* _map = nullptr;
+    std::size_t _map_size = 0;
+
+    std::size_t _end = 0;   // the end of the last complete record
+
+    std::vector<entry> _entries;
+    std::map<std::pair<std::uint64_t, std::uint64_t>, std::vector<std::size_t>> _by_fingerprint;
+};
+
+// marks a call that uses the file, close() leaves the file to the last one. Constructed and destroyed
+// with the GIL held, around the scopes that release it.
+class cex_archive::use_scope
+{
+public:
+
+    explicit use_scope(cex_archive& a) :
+        _a(a),
+        _f(a.file())
+    {
+        _a._users++;
+    }
+
+    ~use_scope()
+    {
+        if ( --_a._users == 0 && _a._closed )
+        {
+            delete _a._pFile;
+            _a._pFile = nullptr;
+        }
+    }
+
+    archive_file& file()
+    {
+        return _f;
+    }
+
+private:
+
+    cex_archive& _a;
+    archive_file& _f;
+};
+
+cex_archive::cex_archive(archive_file* pFile) :
+    _pFile(pFile),
+    _users(0),
+    _closed(false)
+{
+}
+
+cex_archive::~cex_archive()
+{
+    delete _pFile;
+}
+
+void
+cex_archive::initialize(PyObject* module)
+{
+    static PyMethodDef methods[] = {
+
+        PYTHONWRAPPER_METH_NOARGS(cex_archive, size, 0, "return the number of cexes in the archive"),
+        PYTHONWRAPPER_METH_O(cex_archive, record, 0, "return the fingerprint, po and frame of a cex as a dict, without reading it"),
+        PYTHONWRAPPER_METH_O(cex_archive, get, 0, "read a cex from the archive"),
+        PYTHONWRAPPER_METH_KEYWORDS(cex_archive, find, 0, "return the indices of the cexes with a fingerprint, po and frame, each of them optional"),
+        PYTHONWRAPPER_METH_KEYWORDS(cex_archive, append, 0, "append a cex, for a fingerprint or the current network, return its index"),
+        PYTHONWRAPPER_METH_KEYWORDS(cex_archive, append_vector, 0, "append the cexes of cex_get_vector(), return the number appended"),
+        PYTHONWRAPPER_METH_NOARGS(cex_archive, refresh, 0, "index the cexes appended by other processes"),
+        PYTHONWRAPPER_METH_NOARGS(cex_archive, close, 0, "unmap and close the archive"),
+
+        { NULL }  // sentinel
+    };
+
+    _type.tp_methods = methods;
+
+    base::initialize("_pyabc.cex_archive");
+    add_to_module(module, "cex_archive");
+}
+
+archive_file& cex_archive::file()
+{
+    if ( !_pFile || _closed )
+    {
+        PyErr_SetString(PyExc_ValueError, "the archive is closed");
+        throw exception();
+    }
+
+    return *_pFile;
+}
+
+namespace
+{
+
+std::size_t index_arg(archive_file& f, PyObject* pyi)
+{
+    long i = Int_AsLong(pyi);
+
+    if ( i < 0 || static_cast<std::size_t>(i) >= f.size() )
+    {
+        PyErr_SetString(PyExc_IndexError, "cex archive index out of range");
+        throw exception();
+    }
+
+    return i;
+}
+
+} // unnamed namespace
+
+ref<PyObject> cex_archive::size()
+{
+    return Int_FromLong( file().size() );
+}
+
+ref<PyObject> cex_archive::record(PyObject* pyi)
+{
+    archive_file& f = file();
+    archive_file::entry e = f.at( index_arg(f, pyi) );
+
+    ref<PyObject> res = Dict_New();
+
+    Dict_SetItemString(res, "fingerprint", String_FromString(e.fingerprint.hex().c_str()));
+    Dict_SetItemString(res, "po", Int_FromLong(e.po));
+    Dict_SetItemString(res, "frame", Int_FromLong(e.frame));
+
+    return res;
+}
+
+ref<PyObject> cex_archive::get(PyObject* pyi)
+{
+    archive_file& f = file();
+
+    Abc_Cex_t* pCare = nullptr;
+    Abc_Cex_t* pCex = f.read( index_arg(f, pyi), &pCare );
+
+    if ( !pCex )
+    {
+        return None;
+    }
+
+    ref<PyObject> res = cex::build(pCex);
+    Abc_CexFree(pCex);
+
+    if ( pCare )
+    {
+        cex::ensure(res).set_care(pCare);
+    }
+
+    return res;
+}
+
+ref<PyObject> cex_archive::find(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "fingerprint", "po", "frame", NULL };
+
+    char* fingerprint = nullptr;
+    int po = -1;
+    int frame = -1;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "|zii:find", kwlist, &fingerprint, &po, &frame);
+
+    hash128 h;
+
+    if ( fingerprint && !parse_fingerprint(fingerprint, h) )
+    {
+        PyErr_SetString(PyExc_ValueError, "a fingerprint is a string of 32 hex digits");
+        throw exception();
+    }
+
+    std::vector<std::size_t> indices = file().find( fingerprint ? &h : nullptr, po, frame );
+
+    ref<PyObject> res = List_New( indices.size() );
+
+    for ( std::size_t i = 0 ; i < indices.size() ; i++ )
+    {
+        List_SetItem( res, i, Int_FromLong(indices[i]) );
+    }
+
+    return res;
+}
+
+ref<PyObject> cex_archive::append(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "cex", "fingerprint", NULL };
+
+    PyObject* pycex = nullptr;
+    char* fingerprint = nullptr;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "O|z:append", kwlist, &pycex, &fingerprint);
+
+    use_scope use(*this);
+    cex& c = cex::ensure(pycex);
+
+    hash128 h;
+
+    if ( !fingerprint_arg(fingerprint, h) )
+    {
+        return None;
+    }
+
+    std::string buf;
+    put_record(buf, h, c.get(), c.care());
+
+    std::size_t index;
+    bool ok;
+
+    {
+        enable_threads scope;
+        ok = use.file().append(buf, index);
+    }
+
+    if ( !ok )
+    {
+        return None;
+    }
+
+    return Int_FromLong(index);
+}
+
+ref<PyObject> cex_archive::append_vector(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "fingerprint", NULL };
+
+    char* fingerprint = nullptr;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "|z:append_vector", kwlist, &fingerprint);
+
+    use_scope use(*this);
+
+    hash128 h;
+
+    if ( !fingerprint_arg(fingerprint, h) )
+    {
+        return None;
+    }
+
+    Vec_Ptr_t* vCexes = Abc_FrameReadCexVec( Abc_FrameGetGlobalFrame() );
+
+    std::string buf;
+    int n = 0;
+
+    if ( vCexes )
+    {
+        Abc_Cex_t* pCex;
+        int i;
+
+        Vec_PtrForEachEntry( Abc_Cex_t*, vCexes, pCex, i )
+        {
+            if ( pCex && pCex != reinterpret_cast<Abc_Cex_t*>(1) )
+            {
+                put_record(buf, h, pCex, nullptr);
+                n++;
+            }
+        }
+    }
+
+    if ( n == 0 )
+    {
+        return Int_FromLong(0);
+    }
+
+    std::size_t first;
+    bool ok;
+
+    {
+        enable_threads scope;
+        ok = use.file().append(buf, first);
+    }
+
+    if ( !ok )
+    {
+        return None;
+    }
+
+    return Int_FromLong(n);
+}
+
+ref<PyObject> cex_archive::refresh()
+{
+    use_scope use(*this);
+
+    bool ok;
+
+    {
+        enable_threads scope;
+        ok = use.file().refresh();
+    }
+
+    return Bool_FromLong(ok);
+}
+
+void cex_archive::close()
+{
+    _closed = true;
+
+    if ( _users == 0 )
+    {
+        delete _pFile;
+        _pFile = nullptr;
+    }
+}
+
+ref<PyObject> cex_archive_open(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "path", "writable", NULL };
+
+    char* path = nullptr;
+    int writable = 0;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "s|i:cex_archive_open", kwlist, &path, &writable);
+
+    archive_file* pFile;
+
+    {
+        enable_threads scope;
+        pFile = archive_file::open(path, writable);
+    }
+
+    if ( !pFile )
+    {
+        return None;
+    }
+
+    return cex_archive::build(pFile);
+}
+
+} // namespace pyabc
@@ -0,0 +1,54 @@
+#ifndef pyabc_archive__H
+#define pyabc_archive__H
+
+#include "pyabc.h"
+
+namespace pyabc
+{
+
+class archive_file;
+
+// An append-only file of cexes, each stored as a record header (the fingerprint of the design, the
+// po and the frame) followed by its serialization, as in cex.dumps(). The file is mapped read-only,
+// and each cex is built from its payload when it is requested. Writers keep an index of the record
+// headers in a sidecar file (<path>.idx), opening an archive reads it and scans only the records
+// after it. Appends take an exclusive lock and refreshes a shared one, so processes can share an
+// archive, and a record cut short by a crash is dropped by the next append. close() during an
+// append or a refresh in another thread takes effect when it returns.
+class cex_archive :
+    public type_base<cex_archive>
+{
+public:
+
+    cex_archive(archive_file* pFile);
+    ~cex_archive();
+
+    static void initialize(PyObject* module);
+
+    ref<PyObject> size();
+    ref<PyObject> record(PyObject* pyi);
+    ref<PyObject> get(PyObject* pyi);
+    ref<PyObject> find(PyObject* args, PyObject* kwds);
+
+    ref<PyObject> append(PyObject* args, PyObject* kwds);
+    ref<PyObject> append_vector(PyObject* args, PyObject* kwds);
+
+    ref<PyObject> refresh();
+    void close();
+
+private:
+
+    class use_scope;
+
+    archive_file& file();
+
+    archive_file* _pFile;
+    int _users;
+    bool _closed;
+};
+
+ref<PyObject> cex_archive_open(PyObject* args, PyObject* kwds);
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_archive__H
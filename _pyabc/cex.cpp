@@ -1,13 +1,22 @@
 #include "cex.h"
+#include "events.h"
+#include "cexmin.h"
 
+#include <base/abc/abc.h>
 #include <base/main/main.h>
 #include <misc/util/utilCex.h>
 
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
 namespace pyabc
 {
 
 cex::cex(Abc_Cex_t* pCex) :
-    _pCex(nullptr)
+    _pCex(nullptr),
+    _pCare(nullptr)
 {
     if (pCex)
     {
@@ -18,6 +27,21 @@ cex::cex(Abc_Cex_t* pCex) :
 cex::~cex()
 {
     Abc_CexFree(_pCex);
+
+    if ( _pCare )
+    {
+        Abc_CexFree(_pCare);
+    }
+}
+
+void cex::set_care(Abc_Cex_t* pCare)
+{
+    if ( _pCare )
+    {
+        Abc_CexFree(_pCare);
+    }
+
+    _pCare = pCare;
 }
 
 void
@@ -30,6 +54,10 @@ cex::initialize(PyObject* module)
         PYTHONWRAPPER_METH_NOARGS(cex, po, 0, ""),
         PYTHONWRAPPER_METH_NOARGS(cex, frame, 0, ""),
         PYTHONWRAPPER_METH_NOARGS(cex, put, 0, ""),
+        PYTHONWRAPPER_METH_NOARGS(cex, dumps, 0, "serialize the cex into a string, see cex_loads()"),
+        PYTHONWRAPPER_METH_O(cex, renumber_po, 0, "return a copy of the cex for a different po"),
+        PYTHONWRAPPER_METH_NOARGS(cex, minimize, 0, "return a sparse copy of the cex that keeps only the bits needed to fail its po on the current network, or None"),
+        PYTHONWRAPPER_METH_NOARGS(cex, care_bits, 0, "return the indices of the bits kept by minimize(), or None for a full cex"),
 
         { NULL }  // sentinel
     };
@@ -70,6 +98,277 @@ void cex::put()
     {
         Abc_FrameSetCex( nullptr );
     }
+
+    events_changed();
+}
+
+// serialized layout: [i32 po][i32 frame][i32 regs][i32 pis][i32 bits] followed by the bits in 32-bit words.
+// The sparse layout has -bits in the header, followed by [i32 n] and n care bits as [u32 index << 1 | value].
+
+namespace
+{
+
+struct cex_header
+{
+    std::int32_t po;
+    std::int32_t frame;
+    std::int32_t regs;
+    std::int32_t pis;
+    std::int32_t bits;
+};
+
+} // unnamed namespace
+
+void cex_write(const Abc_Cex_t* pCex, std::string& buf)
+{
+    cex_header h = { pCex->iPo, pCex->iFrame, pCex->nRegs, pCex->nPis, pCex->nBits };
+
+    buf.append( reinterpret_cast<const char*>(&h), sizeof(h) );
+    buf.append( reinterpret_cast<const char*>(pCex->pData), Abc_BitWordNum(pCex->nBits) * sizeof(unsigned) );
+}
+
+void cex_write_sparse(const Abc_Cex_t* pCex, const Abc_Cex_t* pCare, std::string& buf)
+{
+    cex_header h = { pCex->iPo, pCex->iFrame, pCex->nRegs, pCex->nPis, -pCex->nBits };
+
+    buf.append( reinterpret_cast<const char*>(&h), sizeof(h) );
+
+    std::size_t n_pos = buf.size();
+    std::int32_t n = 0;
+
+    buf.append( reinterpret_cast<const char*>(&n), sizeof(n) );
+
+    for ( int i = 0 ; i < pCex->nBits ; i++ )
+    {
+        if ( Abc_InfoHasBit(pCare->pData, i) )
+        {
+            std::uint32_t bit = i << 1 | Abc_InfoHasBit(pCex->pData, i);
+            buf.append( reinterpret_cast<const char*>(&bit), sizeof(bit) );
+            n++;
+        }
+    }
+
+    memcpy(&buf[n_pos], &n, sizeof(n));
+}
+
+namespace
+{
+
+Abc_Cex_t* cex_read_sparse(const cex_header& h, const char* data, std::size_t size, Abc_Cex_t** ppCare)
+{
+    std::int32_t n;
+
+    if ( size < sizeof(n) )
+    {
+        return nullptr;
+    }
+
+    memcpy(&n, data, sizeof(n));
+    data += sizeof(n);
+
+    if ( n < 0 || size != sizeof(n) + n * sizeof(std::uint32_t) )
+    {
+        return nullptr;
+    }
+
+    Abc_Cex_t* pCex = Abc_CexAlloc(h.regs, h.pis, h.frame + 1);
+    Abc_Cex_t* pCare = Abc_CexAlloc(h.regs, h.pis, h.frame + 1);
+
+    pCex->iPo = pCare->iPo = h.po;
+    pCex->iFrame = pCare->iFrame = h.frame;
+
+    for ( std::int32_t i = 0 ; i < n ; i++ )
+    {
+        std::uint32_t bit;
+        memcpy(&bit, data + i * sizeof(bit), sizeof(bit));
+
+        if ( (bit >> 1) >= static_cast<std::uint32_t>(pCex->nBits) )
+        {
+            Abc_CexFree(pCex);
+            Abc_CexFree(pCare);
+            return nullptr;
+        }
+
+        Abc_InfoSetBit( pCare->pData, bit >> 1 );
+
+        if ( bit & 1 )
+        {
+            Abc_InfoSetBit( pCex->pData, bit >> 1 );
+        }
+    }
+
+    if ( ppCare )
+    {
+        *ppCare = pCare;
+    }
+    else
+    {
+        Abc_CexFree(pCare);
+    }
+
+    return pCex;
+}
+
+} // unnamed namespace
+
+Abc_Cex_t* cex_read(const char* data, std::size_t size, Abc_Cex_t** ppCare)
+{
+    cex_header h;
+
+    if ( size < sizeof(h) )
+    {
+        return nullptr;
+    }
+
+    memcpy(&h, data, sizeof(h));
+
+    // sparse counterexamples store the negated bit count, INT_MIN cannot be negated
+    bool sparse = h.bits < 0;
+
+    if ( h.bits == std::numeric_limits<std::int32_t>::min() )
+    {
+        return nullptr;
+    }
+
+    if ( sparse )
+    {
+        h.bits = -h.bits;
+    }
+
+    if ( h.regs < 0 || h.pis < 0 || h.frame < 0 )
+    {
+        return nullptr;
+    }
+
+    std::int64_t bits = std::int64_t(h.regs) + std::int64_t(h.pis) * (std::int64_t(h.frame) + 1);
+
+    if ( bits > std::numeric_limits<std::int32_t>::max() || bits != h.bits )
+    {
+        return nullptr;
+    }
+
+    if ( sparse )
+    {
+        return cex_read_sparse(h, data + sizeof(h), size - sizeof(h), ppCare);
+    }
+
+    std::size_t nWords = Abc_BitWordNum(h.bits);
+
+    if ( size != sizeof(h) + nWords * sizeof(unsigned) )
+    {
+        return nullptr;
+    }
+
+    Abc_Cex_t* pCex = Abc_CexAlloc(h.regs, h.pis, h.frame + 1);
+    pCex->iPo = h.po;
+    pCex->iFrame = h.frame;
+    memcpy(pCex->pData, data + sizeof(h), nWords * sizeof(unsigned));
+
+    return pCex;
+}
+
+ref<PyObject> cex::dumps()
+{
+    std::string buf;
+
+    if ( _pCare )
+    {
+        cex_write_sparse(_pCex, _pCare, buf);
+    }
+    else
+    {
+        cex_write(_pCex, buf);
+    }
+
+    return String_FromStringAndSize(buf.data(), buf.size());
+}
+
+ref<PyObject> cex::renumber_po(PyObject* pyPo)
+{
+    ref<PyObject> res = cex::build(_pCex);
+    cex::ensure(res).get()->iPo = Int_AsLong(pyPo);
+
+    if ( _pCare )
+    {
+        Abc_Cex_t* pCare = Abc_CexDup(_pCare, -1);
+        pCare->iPo = Int_AsLong(pyPo);
+        cex::ensure(res).set_care(pCare);
+    }
+
+    return res;
+}
+
+ref<PyObject> cex::minimize()
+{
+    Abc_Ntk_t* pNtk = Abc_FrameReadNtk( Abc_FrameGetGlobalFrame() );
+
+    Abc_Cex_t* pMin = nullptr;
+    Abc_Cex_t* pCare = nullptr;
+
+    bool ok;
+
+    {
+        enable_threads scope;
+        ok = cex_care_set(pNtk, _pCex, &pMin, &pCare);
+    }
+
+    if ( !ok )
+    {
+        return None;
+    }
+
+    ref<PyObject> res = cex::build(pMin);
+    Abc_CexFree(pMin);
+
+    cex::ensure(res).set_care(pCare);
+
+    return res;
+}
+
+ref<PyObject> cex::care_bits()
+{
+    if ( !_pCare )
+    {
+        return None;
+    }
+
+    ref<PyObject> res = List_New(0);
+
+    for ( int i = 0 ; i < _pCare->nBits ; i++ )
+    {
+        if ( Abc_InfoHasBit(_pCare->pData, i) )
+        {
+            List_Append( res, Int_FromLong(i) );
+        }
+    }
+
+    return res;
+}
+
+ref<PyObject> cex_loads(PyObject* pybuf)
+{
+    char* data;
+    Py_ssize_t size;
+
+    String_AsStringAndSize(pybuf, &data, &size);
+
+    Abc_Cex_t* pCare = nullptr;
+    Abc_Cex_t* pCex = cex_read(data, size, &pCare);
+
+    if ( !pCex )
+    {
+        return None;
+    }
+
+    ref<PyObject> res = cex::build(pCex);
+    Abc_CexFree(pCex);
+
+    if ( pCare )
+    {
+        cex::ensure(res).set_care(pCare);
+    }
+
+    return res;
 }
 
 ref<PyObject> cex_get_vector()
@@ -143,4 +442,74 @@ ref<PyObject> status_get_vector()
     return res;
 }
 
+ref<PyObject> cex_set_vector(PyObject* pycexes)
+{
+    Vec_Ptr_t* vCexVec = Vec_PtrAlloc(0);
+
+    try
+    {
+        for_iterator(pycexes, [&](PyObject* item)
+        {
+            if ( item == Py_None )
+            {
+                Vec_PtrPush( vCexVec, nullptr );
+            }
+            else if ( item == Py_True )
+            {
+                Vec_PtrPush( vCexVec, reinterpret_cast<void*>(1) );
+            }
+            else
+            {
+                Vec_PtrPush( vCexVec, Abc_CexDup(cex::ensure(item).get(), -1) );
+            }
+        });
+    }
+    catch(...)
+    {
+        // an item that is not a cex, or a failing iterator
+        for ( int i = 0 ; i < Vec_PtrSize(vCexVec) ; i++ )
+        {
+            Abc_Cex_t* pCex = static_cast<Abc_Cex_t*>( Vec_PtrEntry(vCexVec, i) );
+
+            if ( pCex && pCex != reinterpret_cast<Abc_Cex_t*>(1) )
+            {
+                Abc_CexFree(pCex);
+            }
+        }
+
+        Vec_PtrFree( vCexVec );
+        throw;
+    }
+
+    Abc_FrameReplaceCexVec( Abc_FrameGetGlobalFrame(), &vCexVec );
+
+    events_changed();
+
+    return None;
+}
+
+ref<PyObject> status_set_vector(PyObject* pystatuses)
+{
+    Vec_Int_t* vStatuses = Vec_IntAlloc(0);
+
+    try
+    {
+        for_iterator(pystatuses, [&](PyObject* item)
+        {
+            Vec_IntPush( vStatuses, Int_AsLong(item) );
+        });
+    }
+    catch(...)
+    {
+        Vec_IntFree( vStatuses );
+        throw;
+    }
+
+    Abc_FrameReplacePoStatuses( Abc_FrameGetGlobalFrame(), &vStatuses );
+
+    events_changed();
+
+    return None;
+}
+
 } // namespace pyabc
@@ -3,6 +3,9 @@
 
 #include "pyabc.h"
 
+#include <cstddef>
+#include <string>
+
 ABC_NAMESPACE_HEADER_START
 typedef struct Abc_Cex_t_ Abc_Cex_t;
 ABC_NAMESPACE_HEADER_END
@@ -28,16 +31,48 @@ public:
 
     void put();
 
+    ref<PyObject> dumps();
+    ref<PyObject> renumber_po(PyObject* pyPo);
+
+    ref<PyObject> minimize();
+    ref<PyObject> care_bits();
+
+    Abc_Cex_t* get() const
+    {
+        return _pCex;
+    }
+
+    // the care set of a minimized cex, with the same shape as the cex, or nullptr
+    Abc_Cex_t* care() const
+    {
+        return _pCare;
+    }
+
+    // take ownership of a care set
+    void set_care(Abc_Cex_t* pCare);
 
 private:
 
     Abc_Cex_t* _pCex;
+    Abc_Cex_t* _pCare;
 };
 
+// serialize a cex in the layout of cex.dumps(), and back (nullptr if the data is malformed)
+void cex_write(const Abc_Cex_t* pCex, std::string& buf);
+Abc_Cex_t* cex_read(const char* data, std::size_t size, Abc_Cex_t** ppCare=nullptr);
+
+// the sparse layout of a cex with a care set, which holds only the care bits. cex_read() reads it,
+// and returns the care set in ppCare if it is not nullptr.
+void cex_write_sparse(const Abc_Cex_t* pCex, const Abc_Cex_t* pCare, std::string& buf);
+
 ref<PyObject> cex_get_vector();
 ref<PyObject> cex_get();
 ref<PyObject> status_get_vector();
 
+ref<PyObject> cex_loads(PyObject* pybuf);
+ref<PyObject> cex_set_vector(PyObject* pycexes);
+ref<PyObject> status_set_vector(PyObject* pystatuses);
+
 } // namespace pyabc
 
 #endif // ifndef pyabc_cex__H
@@ -0,0 +1,226 @@
+#include "cexmin.h"
+#include "aig.h"
+
+#include <base/abc/abc.h>
+#include <misc/util/utilCex.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace pyabc
+{
+
+namespace
+{
+
+enum : std::uint8_t { ternary_0 = 0, ternary_1 = 1, ternary_x = 2 };
+
+bool lit_value(const std::vector<bool>& values, std::int32_t lit)
+{
+    return values[lit >> 1] != static_cast<bool>(lit & 1);
+}
+
+std::uint8_t lit_ternary(const std::vector<std::uint8_t>& values, std::int32_t lit)
+{
+    std::uint8_t x = values[lit >> 1];
+    return x == ternary_x ? x : x ^ (lit & 1);
+}
+
+// the values of all variables in each frame of the cex
+void simulate(const aig_flat& aig, const Abc_Cex_t* pCex, std::vector<std::vector<bool>>& frames)
+{
+    frames.assign( pCex->iFrame + 1, std::vector<bool>(aig.n_vars(), false) );
+
+    for ( int f = 0 ; f <= pCex->iFrame ; f++ )
+    {
+        std::vector<bool>& values = frames[f];
+
+        for ( int i = 0 ; i < aig.nPis ; i++ )
+        {
+            values[1 + i] = Abc_InfoHasBit( pCex->pData, pCex->nRegs + f * pCex->nPis + i );
+        }
+
+        for ( int i = 0 ; i < aig.nLatches ; i++ )
+        {
+            values[1 + aig.nPis + i] = f == 0 ? Abc_InfoHasBit( pCex->pData, i ) : lit_value( frames[f - 1], aig.next[i] );
+        }
+
+        for ( std::size_t i = 0 ; i < aig.fanin0.size() ; i++ )
+        {
+            values[1 + aig.n_cis() + i] = lit_value(values, aig.fanin0[i]) && lit_value(values, aig.fanin1[i]);
+        }
+    }
+}
+
+// justify the failing PO backwards from its frame, return the care set as a bit per cex bit
+std::vector<bool> justify(const aig_flat& aig, const Abc_Cex_t* pCex, const std::vector<std::vector<bool>>& frames)
+{
+    std::vector<bool> care( pCex->nBits, false );
+
+    std::vector<bool> required( aig.n_vars(), false );
+    required[ aig.pos[pCex->iPo] >> 1 ] = true;
+
+    for ( int f = pCex->iFrame ; f >= 0 ; f-- )
+    {
+        const std::vector<bool>& values = frames[f];
+
+        // the ANDs are numbered in topological order, fanins before fanouts
+        for ( int v = aig.n_vars() - 1 ; v > aig.n_cis() ; v-- )
+        {
+            if ( !required[v] )
+            {
+                continue;
+            }
+
+            std::int32_t a = aig.fanin0[v - 1 - aig.n_cis()];
+            std::int32_t b = aig.fanin1[v - 1 - aig.n_cis()];
+
+            if ( values[v] )
+            {
+                required[a >> 1] = true;
+                required[b >> 1] = true;
+                continue;
+            }
+
+            // one controlling fanin is enough, prefer one that is already required
+            bool a0 = !lit_value(values, a);
+            bool b0 = !lit_value(values, b);
+
+            if ( a0 && ( !b0 || required[a >> 1] || !required[b >> 1] ) )
+            {
+                required[a >> 1] = true;
+            }
+            else
+            {
+                required[b >> 1] = true;
+            }
+        }
+
+        std::vector<bool> previous( f > 0 ? aig.n_vars() : 0, false );
+
+        for ( int i = 0 ; i < aig.nPis ; i++ )
+        {
+            if ( required[1 + i] )
+            {
+                care[ pCex->nRegs + f * pCex->nPis + i ] = true;
+            }
+        }
+
+        for ( int i = 0 ; i < aig.nLatches ; i++ )
+        {
+            if ( !required[1 + aig.nPis + i] )
+            {
+                continue;
+            }
+
+            if ( f == 0 )
+            {
+                care[i] = true;
+            }
+            else
+            {
+                previous[ aig.next[i] >> 1 ] = true;
+            }
+        }
+
+        required.swap(previous);
+    }
+
+    return care;
+}
+
+// ternary simulation with the bits outside the care set at X, true if the PO is still 1
+bool check_care_set(const aig_flat& aig, const Abc_Cex_t* pCex, const std::vector<bool>& care)
+{
+    std::vector<std::uint8_t> values( aig.n_vars(), ternary_0 );
+    std::vector<std::uint8_t> previous;
+
+    auto input = [&](int bit)
+    {
+        return care[bit] ? static_cast<std::uint8_t>( Abc_InfoHasBit(pCex->pData, bit) ) : ternary_x;
+    };
+
+    for ( int f = 0 ; f <= pCex->iFrame ; f++ )
+    {
+        previous.swap(values);
+        values.assign( aig.n_vars(), ternary_0 );
+
+        for ( int i = 0 ; i < aig.nPis ; i++ )
+        {
+            values[1 + i] = input( pCex->nRegs + f * pCex->nPis + i );
+        }
+
+        for ( int i = 0 ; i < aig.nLatches ; i++ )
+        {
+            values[1 + aig.nPis + i] = f == 0 ? input(i) : lit_ternary( previous, aig.next[i] );
+        }
+
+        for ( std::size_t i = 0 ; i < aig.fanin0.size() ; i++ )
+        {
+            std::uint8_t a = lit_ternary(values, aig.fanin0[i]);
+            std::uint8_t b = lit_ternary(values, aig.fanin1[i]);
+
+            values[1 + aig.n_cis() + i] = a == ternary_0 || b == ternary_0 ? ternary_0 : a == ternary_1 && b == ternary_1 ? ternary_1 : ternary_x;
+        }
+    }
+
+    return lit_ternary( values, aig.pos[pCex->iPo] ) == ternary_1;
+}
+
+} // unnamed namespace
+
+bool cex_care_set(Abc_Ntk_t* pNtk, const Abc_Cex_t* pCex, Abc_Cex_t** ppMin, Abc_Cex_t** ppCare)
+{
+    if ( !pNtk || !Abc_NtkIsStrash(pNtk) )
+    {
+        return false;
+    }
+
+    if ( pCex->nRegs != Abc_NtkLatchNum(pNtk) || pCex->nPis != Abc_NtkPiNum(pNtk) || pCex->iPo < 0 || pCex->iPo >= Abc_NtkPoNum(pNtk) || pCex->iFrame < 0 || pCex->nBits != pCex->nRegs + pCex->nPis * (pCex->iFrame + 1) )
+    {
+        return false;
+    }
+
+    aig_flat aig;
+    aig_flatten(pNtk, aig);
+
+    std::vector<std::vector<bool>> frames;
+    simulate(aig, pCex, frames);
+
+    if ( !lit_value( frames[pCex->iFrame], aig.pos[pCex->iPo] ) )
+    {
+        return false;
+    }
+
+    std::vector<bool> care = justify(aig, pCex, frames);
+
+    if ( !check_care_set(aig, pCex, care) )
+    {
+        return false;
+    }
+
+    Abc_Cex_t* pMin = Abc_CexDup( const_cast<Abc_Cex_t*>(pCex), -1 );
+    Abc_Cex_t* pCare = Abc_CexAlloc( pCex->nRegs, pCex->nPis, pCex->iFrame + 1 );
+
+    pCare->iPo = pCex->iPo;
+    pCare->iFrame = pCex->iFrame;
+
+    for ( int i = 0 ; i < pCex->nBits ; i++ )
+    {
+        if ( care[i] )
+        {
+            Abc_InfoSetBit( pCare->pData, i );
+        }
+        else if ( Abc_InfoHasBit( pMin->pData, i ) )
+        {
+            Abc_InfoXorBit( pMin->pData, i );
+        }
+    }
+
+    *ppMin = pMin;
+    *ppCare = pCare;
+
+    return true;
+}
+
+} // namespace pyabc
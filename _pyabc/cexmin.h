@@ -0,0 +1,27 @@
+#ifndef pyabc_cexmin__H
+#define pyabc_cexmin__H
+
+#include "pyabc.h"
+
+ABC_NAMESPACE_HEADER_START
+typedef struct Abc_Cex_t_ Abc_Cex_t;
+typedef struct Abc_Ntk_t_ Abc_Ntk_t;
+ABC_NAMESPACE_HEADER_END
+
+namespace pyabc
+{
+
+// Compute a care set of a cex on a strashed network: the register and PI bits that are enough to
+// reach po at frame with every other bit unknown. The values of the cex are simulated, then the
+// failing PO is justified backwards: an AND at 1 needs both fanins, an AND at 0 needs one fanin at 0,
+// a latch output needs its input in the previous frame or its initial value. The result is checked
+// by ternary simulation with the bits outside the care set set to X.
+//
+// Returns false if the cex does not match the network or does not fail po at frame. Otherwise
+// ppMin receives a copy of the cex with the bits outside the care set cleared, and ppCare a cex of
+// the same shape whose bits mark the care set.
+bool cex_care_set(Abc_Ntk_t* pNtk, const Abc_Cex_t* pCex, Abc_Cex_t** ppMin, Abc_Cex_t** ppCare);
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_cexmin__H
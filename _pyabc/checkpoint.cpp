@@ -0,0 +1,516 @@
+#include "checkpoint.h"
+#include "command.h"
+#include "snapshot.h"
+#include "events.h"
+
+#include <base/cmd/cmd.h>
+#include <base/main/main.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+namespace pyabc
+{
+
+namespace
+{
+
+const char checkpoint_magic[8] = { 'P', 'Y', 'A', 'B', 'C', 'C', 'P', '1' };
+
+enum { flag_planned = 1 };
+
+struct checkpoint_state
+{
+    bool enabled = false;
+    bool planned = false;
+    bool running_plan = false;
+    bool skip_command = false;      // do not record the resume command that is completing
+    bool write_failed = false;      // a checkpoint could not be written since checkpointing started
+
+    std::string path;
+    double interval = 0.0;
+
+    std::vector<std::string> commands;
+    std::size_t position = 0;
+
+    std::chrono::steady_clock::time_point last;
+};
+
+checkpoint_state state;
+
+void put_u32(std::string& buf, std::uint32_t x)
+{
+    buf.append(reinterpret_cast<const char*>(&x), sizeof(x));
+}
+
+bool get_u32(const char*& data, const char* end, std::uint32_t& x)
+{
+    if ( end - data < static_cast<std::ptrdiff_t>(sizeof(x)) )
+    {
+        return false;
+    }
+
+    memcpy(&x, data, sizeof(x));
+    data += sizeof(x);
+
+    return true;
+}
+
+bool get_string(const char*& data, const char* end, std::string& s)
+{
+    std::uint32_t n;
+
+    if ( !get_u32(data, end, n) || static_cast<std::size_t>(end - data) < n )
+    {
+        return false;
+    }
+
+    s.assign(data, n);
+    data += n;
+
+    return true;
+}
+
+// layout: [magic][u32 flags][u32 position][u32 n] n * ([u32 size][command]) [u32 size][snapshot]
+
+bool write_checkpoint()
+{
+    std::string buf(checkpoint_magic, sizeof(checkpoint_magic));
+
+    put_u32(buf, state.planned ? flag_planned : 0);
+    put_u32(buf, state.position);
+    put_u32(buf, state.commands.size());
+
+    for ( const std::string& cmd : state.commands )
+    {
+        put_u32(buf, cmd.size());
+        buf.append(cmd);
+    }
+
+    std::string snapshot;
+
+    if ( !save_snapshot(snapshot) )
+    {
+        return false;
+    }
+
+    put_u32(buf, snapshot.size());
+    buf.append(snapshot);
+
+    // write a new file and rename it over the old one, so that a crash leaves the previous checkpoint intact
+    std::string tmp = state.path + ".tmp";
+
+    FILE* f = fopen(tmp.c_str(), "wb");
+
+    if ( !f )
+    {
+        return false;
+    }
+
+    bool ok = fwrite(buf.data(), 1, buf.size(), f) == buf.size() && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    ok = fclose(f) == 0 && ok;
+
+    if ( !ok || rename(tmp.c_str(), state.path.c_str()) != 0 )
+    {
+        unlink(tmp.c_str());
+        return false;
+    }
+
+    state.last = std::chrono::steady_clock::now();
+
+    return true;
+}
+
+bool due()
+{
+    return state.interval <= 0.0 || std::chrono::steady_clock::now() - state.last >= std::chrono::duration<double>(state.interval);
+}
+
+bool read_checkpoint(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+
+    if ( !f )
+    {
+        return false;
+    }
+
+    std::string buf;
+
+    char chunk[1 << 16];
+    std::size_t n;
+
+    while ( (n = fread(chunk, 1, sizeof(chunk), f)) > 0 )
+    {
+        buf.append(chunk, n);
+    }
+
+    bool ok = !ferror(f);
+    fclose(f);
+
+    const char* data = buf.data();
+    const char* end = data + buf.size();
+
+    if ( !ok || buf.size() < sizeof(checkpoint_magic) || memcmp(data, checkpoint_magic, sizeof(checkpoint_magic)) != 0 )
+    {
+        return false;
+    }
+
+    data += sizeof(checkpoint_magic);
+
+    std::uint32_t flags;
+    std::uint32_t position;
+    std::uint32_t nCommands;
+
+    if ( !get_u32(data, end, flags) || !get_u32(data, end, position) || !get_u32(data, end, nCommands) || position > nCommands )
+    {
+        return false;
+    }
+
+    std::vector<std::string> commands;
+
+    for ( std::uint32_t i = 0 ; i < nCommands ; i++ )
+    {
+        std::string cmd;
+
+        if ( !get_string(data, end, cmd) )
+        {
+            return false;
+        }
+
+        commands.push_back(cmd);
+    }
+
+    std::uint32_t snapshot_size;
+
+    if ( !get_u32(data, end, snapshot_size) || static_cast<std::size_t>(end - data) != snapshot_size || !restore_snapshot(data, snapshot_size) )
+    {
+        return false;
+    }
+
+    state.planned = flags & flag_planned;
+    state.commands.swap(commands);
+    state.position = position;
+
+    return true;
+}
+
+// split a script into commands at the semicolons that are not quoted, as ABC does
+std::vector<std::string> split_script(const char* script)
+{
+    std::vector<std::string> commands;
+    std::string cmd;
+
+    bool quoted = false;
+
+    auto push = [&]()
+    {
+        std::size_t b = cmd.find_first_not_of(" \t\n");
+
+        if ( b != std::string::npos )
+        {
+            commands.push_back( cmd.substr(b, cmd.find_last_not_of(" \t\n") - b + 1) );
+        }
+
+        cmd.clear();
+    };
+
+    for ( const char* p = script ; *p ; p++ )
+    {
+        if ( *p == '"' )
+        {
+            quoted = !quoted;
+        }
+
+        if ( *p == ';' && !quoted )
+        {
+            push();
+        }
+        else
+        {
+            cmd.push_back(*p);
+        }
+    }
+
+    push();
+
+    return commands;
+}
+
+// run the planned commands from the current position, checkpointing as they complete. It stops at the
+// first command that fails, with its status in rc, and returns false if a checkpoint cannot be written.
+bool run_plan(int& rc)
+{
+    bool ok = true;
+
+    rc = 0;
+
+    state.running_plan = true;
+
+    while ( state.position < state.commands.size() )
+    {
+        rc = execute_command( state.commands[state.position].c_str() );
+
+        if ( rc != 0 )
+        {
+            break;
+        }
+
+        state.position++;
+
+        if ( ( state.position == state.commands.size() || due() ) && !write_checkpoint() )
+        {
+            ok = false;
+            break;
+        }
+    }
+
+    state.running_plan = false;
+    state.enabled = false;
+
+    return ok;
+}
+
+void start(const char* path, double interval, bool planned)
+{
+    state.enabled = true;
+    state.planned = planned;
+    state.write_failed = false;
+    state.path = path;
+    state.interval = interval;
+}
+
+enum resume_status
+{
+    resume_done,
+    resume_cannot_read,
+    resume_cannot_write
+};
+
+// restore a checkpoint, and continue its plan or its recording, with the status of the last command in rc
+resume_status resume(const char* path, double interval, int& rc)
+{
+    rc = 0;
+
+    if ( !read_checkpoint(path) )
+    {
+        return resume_cannot_read;
+    }
+
+    start(path, interval, state.planned);
+
+    if ( state.planned && !run_plan(rc) )
+    {
+        return resume_cannot_write;
+    }
+
+    return resume_done;
+}
+
+int abc_command_resume(Abc_Frame_t* pAbc, int argc, char** argv)
+{
+    double interval = 0.0;
+    int i = 1;
+
+    if ( argc > 2 && strcmp(argv[1], "-I") == 0 )
+    {
+        interval = atof(argv[2]);
+        i = 3;
+    }
+
+    if ( argc != i + 1 || argv[i][0] == '-' )
+    {
+        fprintf( stderr, "usage: resume [-I <seconds>] <file>\n" );
+        fprintf( stderr, "\t         restores the state saved in a checkpoint file and continues its flow\n" );
+        fprintf( stderr, "\t-I num : the minimal interval between checkpoints, 0 for every command [default = 0]\n" );
+        return 1;
+    }
+
+    int rc;
+    resume_status status = resume(argv[i], interval, rc);
+
+    // when resume was run by execute_command() at the top level, it is about to be reported as done
+    state.skip_command = state.enabled && execute_command_depth() == 1;
+
+    if ( status == resume_cannot_read )
+    {
+        fprintf( stderr, "resume: cannot read checkpoint \"%s\"\n", argv[i] );
+        return 1;
+    }
+
+    if ( status == resume_cannot_write )
+    {
+        fprintf( stderr, "resume: cannot write checkpoint \"%s\"\n", argv[i] );
+        return 1;
+    }
+
+    return rc;
+}
+
+void atfork_child_handler()
+{
+    // children (split jobs) run commands at depth 0 too, but the checkpoint belongs to the parent
+    state.enabled = false;
+}
+
+void cannot_write(const char* path)
+{
+    PyErr_Format(PyExc_IOError, "cannot write checkpoint \"%s\"", path);
+    throw exception();
+}
+
+} // unnamed namespace
+
+void checkpoint_init()
+{
+    Cmd_CommandAdd( Abc_FrameGetGlobalFrame(), "Python", "resume", abc_command_resume, 1 );
+
+    pthread_atfork(nullptr, nullptr, atfork_child_handler);
+}
+
+void checkpoint_command_done(const char* cmd)
+{
+    if ( !state.enabled || state.running_plan )
+    {
+        return;
+    }
+
+    if ( state.skip_command )
+    {
+        state.skip_command = false;
+        return;
+    }
+
+    state.commands.push_back(cmd);
+    state.position = state.commands.size();
+
+    // warn once, the previous checkpoint is left in place and later commands keep trying
+    if ( due() && !write_checkpoint() && !state.write_failed )
+    {
+        state.write_failed = true;
+        fprintf( stderr, "checkpoint: cannot write checkpoint \"%s\"\n", state.path.c_str() );
+    }
+}
+
+ref<PyObject> checkpoint_enable(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "path", "interval", NULL };
+
+    char* path = nullptr;
+    double interval = 0.0;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "s|d:checkpoint_enable", kwlist, &path, &interval);
+
+    start(path, interval, false);
+
+    state.commands.clear();
+    state.position = 0;
+
+    bool ok;
+
+    {
+        enable_threads scope;
+        ok = write_checkpoint();
+    }
+
+    return Bool_FromLong(ok);
+}
+
+ref<PyObject> checkpoint_disable()
+{
+    state.enabled = false;
+    return None;
+}
+
+ref<PyObject> checkpoint_run(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "script", "path", "interval", NULL };
+
+    char* script = nullptr;
+    char* path = nullptr;
+    double interval = 0.0;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "ss|d:checkpoint_run", kwlist, &script, &path, &interval);
+
+    start(path, interval, true);
+
+    state.commands = split_script(script);
+    state.position = 0;
+
+    int rc = 0;
+    bool ok;
+
+    {
+        enable_threads scope;
+        ok = write_checkpoint() && run_plan(rc);
+    }
+
+    events_changed();
+
+    if ( !ok )
+    {
+        state.enabled = false;
+        cannot_write(path);
+    }
+
+    return Int_FromLong(rc);
+}
+
+ref<PyObject> checkpoint_resume(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "path", "interval", NULL };
+
+    char* path = nullptr;
+    double interval = 0.0;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "s|d:checkpoint_resume", kwlist, &path, &interval);
+
+    int rc;
+    resume_status status;
+
+    {
+        enable_threads scope;
+        status = resume(path, interval, rc);
+    }
+
+    events_changed();
+
+    if ( status == resume_cannot_read )
+    {
+        return None;
+    }
+
+    if ( status == resume_cannot_write )
+    {
+        cannot_write(path);
+    }
+
+    return Int_FromLong(rc);
+}
+
+ref<PyObject> checkpoint_history()
+{
+    ref<PyObject> commands = List_New( state.position );
+
+    for ( std::size_t i = 0 ; i < state.position ; i++ )
+    {
+        List_SetItem( commands, i, String_FromString(state.commands[i].c_str()) );
+    }
+
+    return commands;
+}
+
+ref<PyObject> checkpoint_failed()
+{
+    return Bool_FromLong(state.write_failed);
+}
+
+} // namespace pyabc
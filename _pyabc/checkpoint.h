@@ -0,0 +1,32 @@
+#ifndef pyabc_checkpoint__H
+#define pyabc_checkpoint__H
+
+#include "pyabc.h"
+
+namespace pyabc
+{
+
+// Checkpoints are written at the boundaries of top-level commands: after every command, or after
+// the first command that ends at least `interval` seconds after the previous checkpoint. A checkpoint
+// holds a snapshot (network, verification status, status and cex vectors, PO equivalence classes)
+// and the list of commands with the position reached.
+//
+// With checkpoint_enable(), the commands executed so far are recorded. With checkpoint_run(), the
+// commands of a script are planned ahead, and resume continues with the ones that did not complete.
+
+// register the resume command
+void checkpoint_init();
+
+// called by execute_command() after each top-level command
+void checkpoint_command_done(const char* cmd);
+
+ref<PyObject> checkpoint_enable(PyObject* args, PyObject* kwds);
+ref<PyObject> checkpoint_disable();
+ref<PyObject> checkpoint_run(PyObject* args, PyObject* kwds);
+ref<PyObject> checkpoint_resume(PyObject* args, PyObject* kwds);
+ref<PyObject> checkpoint_history();
+ref<PyObject> checkpoint_failed();
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_checkpoint__H
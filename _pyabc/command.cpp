@@ -1,8 +1,15 @@
 #include "command.h"
+#include "progress.h"
+#include "metrics.h"
+#include "checkpoint.h"
+#include "journal.h"
+#include "events.h"
 
 #include <base/main/main.h>
 #include <base/main/mainInt.h>
 
+#include <chrono>
+
 #include <stdio.h>
 
 namespace pyabc
@@ -13,8 +20,19 @@ namespace
 
 ref<PyObject> python_frame_done_callback{ py::None };
 
+// nesting of execute_command(), through Python commands or commands such as resume
+int command_depth = 0;
+
 void frame_done_callback(int frame, int po, int status)
 {
+    progress_frame_done(frame, po, status);
+    journal_frame_done(frame, po, status, command_depth);
+
+    if( !python_frame_done_callback || python_frame_done_callback == py::None )
+    {
+        return;
+    }
+
     try
     {
         gil_state_ensure scope;
@@ -27,6 +45,44 @@ void frame_done_callback(int frame, int po, int status)
 
 } // unnamed namespace
 
+int execute_command(const char* cmd)
+{
+    Abc_Frame_t* pAbc = Abc_FrameGetGlobalFrame();
+
+    // the frame-done hook is always installed, it keeps the progress record up to date
+    auto old_callback = pAbc->pFuncOnFrameDone;
+    pAbc->pFuncOnFrameDone = frame_done_callback;
+
+    auto start = std::chrono::steady_clock::now();
+
+    progress_command_begin(cmd);
+
+    command_depth++;
+    int rc = Cmd_CommandExecute(pAbc, cmd);
+    command_depth--;
+
+    events_command_done(cmd);
+
+    progress_command_end(rc);
+
+    journal_command_done(cmd, command_depth, start, rc);
+
+    pAbc->pFuncOnFrameDone = old_callback;
+
+    if ( command_depth == 0 )
+    {
+        metrics_command_done( std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() );
+        checkpoint_command_done(cmd);
+    }
+
+    return rc;
+}
+
+int execute_command_depth()
+{
+    return command_depth;
+}
+
 ref<PyObject> run_command(PyObject* arg)
 {
     const char* cmd = String_AsString(arg);
@@ -35,22 +91,11 @@ ref<PyObject> run_command(PyObject* arg)
 
     {
         enable_threads scope;
-
-        Abc_Frame_t* pAbc = Abc_FrameGetGlobalFrame();
-
-        if( python_frame_done_callback && python_frame_done_callback != py::None )
-        {
-            auto old_callback = pAbc->pFuncOnFrameDone;
-            pAbc->pFuncOnFrameDone = frame_done_callback;
-            rc = Cmd_CommandExecute(pAbc, cmd);
-            pAbc->pFuncOnFrameDone = old_callback;
-        }
-        else
-        {
-            rc = Cmd_CommandExecute(pAbc, cmd);
-        }
+        rc = execute_command(cmd);
     }
 
+    events_deliver();
+
     return Int_FromLong(rc);
 }
 
@@ -68,6 +113,10 @@ ref<PyObject> python_command_callback;
 
 static int abc_command_callback(Abc_Frame_t * pAbc, int argc, char ** argv)
 {
+    auto start = std::chrono::steady_clock::now();
+
+    int rc;
+
     try
     {
         gil_state_ensure scope;
@@ -81,12 +130,16 @@ static int abc_command_callback(Abc_Frame_t * pAbc, int argc, char ** argv)
 
         ref<PyObject> res = Object_CallFunction(python_command_callback, "(O)", args.get());
 
-        return Int_AsLong(res);
+        rc = Int_AsLong(res);
     }
     catch(...)
     {
-        return -1;
+        rc = -1;
     }
+
+    journal_python_command_done(argc, argv, command_depth, start, rc);
+
+    return rc;
 }
 
 } // unnamed namespace
@@ -6,6 +6,12 @@
 namespace pyabc
 {
 
+// run an ABC command with the pyabc hooks (progress, metrics, checkpoints), called without the GIL
+int execute_command(const char* cmd);
+
+// the number of execute_command() calls in progress
+int execute_command_depth();
+
 ref<PyObject> run_command(PyObject* arg);
 
 void set_command_callback( PyObject* callback );
@@ -0,0 +1,303 @@
+#include "constpo.h"
+#include "aig.h"
+
+#include <base/abc/abc.h>
+#include <base/main/main.h>
+#include <sat/bsat/satSolver.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <thread>
+#include <vector>
+
+namespace pyabc
+{
+
+namespace
+{
+
+enum : std::int8_t
+{
+    po_const0 = 0,
+    po_const1 = 1,
+    po_not_const = -1,
+    po_undecided = -2,
+};
+
+std::uint64_t lit_value(const std::vector<std::uint64_t>& sim, std::int32_t lit)
+{
+    return sim[lit >> 1] ^ ( lit & 1 ? ~std::uint64_t(0) : 0 );
+}
+
+// simulate 64 random patterns per round, and reject the POs that take both values. On return, res
+// holds po_not_const for the rejected POs and the value seen for the others.
+void simulate(const aig_flat& aig, int rounds, std::uint64_t seed, std::vector<std::int8_t>& res)
+{
+    std::vector<std::uint64_t> sim( aig.n_vars(), 0 );
+
+    std::vector<int> candidates;
+    std::vector<std::uint8_t> seen( aig.pos.size(), 0 );   // bit 0: value 0 seen, bit 1: value 1 seen
+
+    for ( std::size_t i = 0 ; i < aig.pos.size() ; i++ )
+    {
+        if ( res[i] == po_undecided )
+        {
+            candidates.push_back(i);
+        }
+    }
+
+    // xorshift64*
+    std::uint64_t x = seed ? seed : 0x9e3779b97f4a7c15ull;
+
+    for ( int r = 0 ; r < rounds && !candidates.empty() ; r++ )
+    {
+        for ( int v = 1 ; v <= aig.n_cis() ; v++ )
+        {
+            x ^= x >> 12;
+            x ^= x << 25;
+            x ^= x >> 27;
+            sim[v] = x * 0x2545f4914f6cdd1dull;
+        }
+
+        for ( std::size_t i = 0 ; i < aig.fanin0.size() ; i++ )
+        {
+            sim[1 + aig.n_cis() + i] = lit_value(sim, aig.fanin0[i]) & lit_value(sim, aig.fanin1[i]);
+        }
+
+        std::size_t n = 0;
+
+        for ( int po : candidates )
+        {
+            std::uint64_t value = lit_value(sim, aig.pos[po]);
+
+            seen[po] |= ( value != ~std::uint64_t(0) ) | ( value != 0 ) << 1;
+
+            if ( seen[po] == 3 )
+            {
+                res[po] = po_not_const;
+            }
+            else
+            {
+                candidates[n++] = po;
+            }
+        }
+
+        candidates.resize(n);
+    }
+
+    for ( int po : candidates )
+    {
+        res[po] = seen[po] == 1 ? po_const0 : po_const1;
+    }
+}
+
+// per-thread SAT state, mapping the AIG variables of a cone to solver variables
+class cone_prover
+{
+public:
+
+    explicit cone_prover(const aig_flat& aig) :
+        _aig(aig),
+        _sat_var( aig.n_vars(), -1 )
+    {
+    }
+
+    // prove that a PO never takes the value opposite to the simulated one
+    std::int8_t prove(int po, std::int8_t value, int nConfLimit)
+    {
+        std::int32_t lit = _aig.pos[po];
+
+        collect_cone(lit >> 1);
+
+        sat_solver* pSat = sat_solver_new();
+        sat_solver_setnvars( pSat, _cone.size() );
+
+        bool ok = true;
+
+        for ( int v : _cone )
+        {
+            if ( v == 0 )
+            {
+                ok = ok && add_clause( pSat, { toLitCond(_sat_var[0], 1) } );
+            }
+            else if ( v > _aig.n_cis() )
+            {
+                int n = _sat_var[v];
+                int a = sat_lit( _aig.fanin0[v - 1 - _aig.n_cis()] );
+                int b = sat_lit( _aig.fanin1[v - 1 - _aig.n_cis()] );
+
+                ok = ok && add_clause( pSat, { toLitCond(n, 1), a } );
+                ok = ok && add_clause( pSat, { toLitCond(n, 1), b } );
+                ok = ok && add_clause( pSat, { toLitCond(n, 0), lit_neg(a), lit_neg(b) } );
+            }
+        }
+
+        std::int8_t res = value;
+
+        if ( ok )
+        {
+            // the PO takes the other value iff its literal evaluates to !value
+            lit_t assumption = value ? lit_neg( sat_lit(lit) ) : sat_lit(lit);
+
+            int status = sat_solver_solve( pSat, &assumption, &assumption + 1, nConfLimit, 0, 0, 0 );
+
+            res = status == l_False ? value : status == l_True ? po_not_const : po_undecided;
+        }
+
+        sat_solver_delete( pSat );
+
+        for ( int v : _cone )
+        {
+            _sat_var[v] = -1;
+        }
+
+        _cone.clear();
+
+        return res;
+    }
+
+private:
+
+    typedef int lit_t;
+
+    lit_t sat_lit(std::int32_t lit) const
+    {
+        return toLitCond( _sat_var[lit >> 1], lit & 1 );
+    }
+
+    bool add_clause(sat_solver* pSat, std::initializer_list<lit_t> lits)
+    {
+        std::vector<lit_t> clause(lits);
+        return sat_solver_addclause( pSat, clause.data(), clause.data() + clause.size() );
+    }
+
+    void collect_cone(int root)
+    {
+        std::vector<int> stack{ root };
+
+        while ( !stack.empty() )
+        {
+            int v = stack.back();
+            stack.pop_back();
+
+            if ( _sat_var[v] >= 0 )
+            {
+                continue;
+            }
+
+            _sat_var[v] = _cone.size();
+            _cone.push_back(v);
+
+            if ( v > _aig.n_cis() )
+            {
+                stack.push_back( _aig.fanin0[v - 1 - _aig.n_cis()] >> 1 );
+                stack.push_back( _aig.fanin1[v - 1 - _aig.n_cis()] >> 1 );
+            }
+        }
+    }
+
+    const aig_flat& _aig;
+
+    std::vector<int> _sat_var;
+    std::vector<int> _cone;
+};
+
+void prove_candidates(const aig_flat& aig, const std::vector<int>& candidates, int nConfLimit, int nThreads, std::vector<std::int8_t>& res)
+{
+    std::atomic<std::size_t> next{ 0 };
+
+    auto worker = [&]()
+    {
+        cone_prover prover(aig);
+
+        for ( std::size_t i = next++ ; i < candidates.size() ; i = next++ )
+        {
+            int po = candidates[i];
+            res[po] = prover.prove(po, res[po], nConfLimit);
+        }
+    };
+
+    if ( nThreads <= 1 )
+    {
+        worker();
+        return;
+    }
+
+    std::vector<std::thread> threads;
+
+    for ( int i = 0 ; i < nThreads ; i++ )
+    {
+        threads.emplace_back(worker);
+    }
+
+    for ( std::thread& t : threads )
+    {
+        t.join();
+    }
+}
+
+} // unnamed namespace
+
+ref<PyObject> const_pos(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "rounds", "conflicts", "threads", "seed", NULL };
+
+    int rounds = 16;
+    int nConfLimit = 100000;
+    int nThreads = 0;
+    unsigned long long seed = 1;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "|iiiK:const_pos", kwlist, &rounds, &nConfLimit, &nThreads, &seed);
+
+    Abc_Ntk_t* pNtk = Abc_FrameReadNtk( Abc_FrameGetGlobalFrame() );
+
+    if ( !pNtk || !Abc_NtkIsStrash(pNtk) )
+    {
+        return None;
+    }
+
+    aig_flat aig;
+    aig_flatten(pNtk, aig);
+
+    std::vector<std::int8_t> res( aig.pos.size(), po_undecided );
+
+    {
+        enable_threads scope;
+
+        // POs driven by a constant, as Abc_FrameCheckPoConst() classifies them
+        for ( std::size_t i = 0 ; i < aig.pos.size() ; i++ )
+        {
+            if ( aig.pos[i] < 2 )
+            {
+                res[i] = aig.pos[i];
+            }
+        }
+
+        simulate(aig, rounds, seed, res);
+
+        std::vector<int> candidates;
+
+        for ( std::size_t i = 0 ; i < aig.pos.size() ; i++ )
+        {
+            if ( res[i] >= 0 && aig.pos[i] >= 2 )
+            {
+                candidates.push_back(i);
+            }
+        }
+
+        if ( nThreads <= 0 )
+        {
+            nThreads = std::thread::hardware_concurrency();
+        }
+
+        nThreads = std::min<std::size_t>( nThreads, candidates.size() );
+
+        prove_candidates(aig, candidates, nConfLimit, nThreads, res);
+    }
+
+    return String_FromStringAndSize( reinterpret_cast<const char*>(res.data()), res.size() );
+}
+
+} // namespace pyabc
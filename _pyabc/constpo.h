@@ -0,0 +1,20 @@
+#ifndef pyabc_constpo__H
+#define pyabc_constpo__H
+
+#include "pyabc.h"
+
+namespace pyabc
+{
+
+// Classify every PO of the current strashed network as constant 0, constant 1 or not constant,
+// combinationally, with the latch outputs as free inputs. POs driven by a constant are classified
+// structurally, as is_const_po() does. Bit-parallel random simulation rejects most of the others,
+// and the survivors are proved constant by SAT on their cones, in parallel threads.
+//
+// Returns a string of n_pos signed bytes: 0 or 1 for a constant, -1 for not constant, -2 when the
+// conflict limit was reached. Returns None if the current network is not strashed.
+ref<PyObject> const_pos(PyObject* args, PyObject* kwds);
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_constpo__H
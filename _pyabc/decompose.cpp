@@ -0,0 +1,494 @@
+#include "decompose.h"
+#include "cex.h"
+#include "events.h"
+#include "fingerprint.h"
+
+#include <base/abc/abc.h>
+#include <base/main/main.h>
+#include <misc/extra/extra.h>
+#include <misc/util/utilCex.h>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace pyabc
+{
+
+namespace
+{
+
+std::vector<int> po_support(Abc_Ntk_t* pNtk, int iPo)
+{
+    std::vector<int> supp;
+
+    Vec_Int_t* vSupp = Abc_NtkNodeSupportInt( pNtk, iPo );
+
+    if ( vSupp )
+    {
+        supp.assign( Vec_IntArray(vSupp), Vec_IntArray(vSupp) + Vec_IntSize(vSupp) );
+        Vec_IntFree( vSupp );
+    }
+
+    std::sort( supp.begin(), supp.end() );
+
+    return supp;
+}
+
+struct po_group
+{
+    std::vector<int> pos;
+    std::vector<int> supp;
+};
+
+// greedily add each PO to the group that already contains the largest fraction of its support,
+// as long as that fraction is at least overlap. The groups that contain each support variable are
+// indexed, so that a PO is only compared with the groups it shares variables with.
+std::vector<po_group> group_pos(Abc_Ntk_t* pNtk, double overlap, std::size_t max_size)
+{
+    std::vector<po_group> groups;
+
+    std::vector<std::vector<int>> var_groups( Abc_NtkCiNum(pNtk) );     // support variable -> groups
+
+    std::vector<int> shared;        // group -> the number of support variables of the PO in the group
+    std::vector<int> touched;
+
+    for ( int iPo = 0 ; iPo < Abc_NtkPoNum(pNtk) ; iPo++ )
+    {
+        std::vector<int> supp = po_support(pNtk, iPo);
+
+        for ( int v : supp )
+        {
+            if ( v >= static_cast<int>(var_groups.size()) )
+            {
+                var_groups.resize(v + 1);
+            }
+
+            for ( int g : var_groups[v] )
+            {
+                if ( shared[g]++ == 0 )
+                {
+                    touched.push_back(g);
+                }
+            }
+        }
+
+        int best = -1;
+        double best_ratio = overlap;
+
+        auto consider = [&](int g, double ratio)
+        {
+            if ( max_size && groups[g].pos.size() >= max_size )
+            {
+                return;
+            }
+
+            if ( ratio >= best_ratio && ( best < 0 || ratio > best_ratio || g < best ) )
+            {
+                best = g;
+                best_ratio = ratio;
+            }
+        };
+
+        for ( int g : touched )
+        {
+            consider( g, double(shared[g]) / supp.size() );
+            shared[g] = 0;
+        }
+
+        touched.clear();
+
+        // the groups that share no variable with the PO, the first one with room if they qualify
+        double untouched_ratio = supp.empty() ? 1.0 : 0.0;
+
+        if ( best < 0 && untouched_ratio >= overlap )
+        {
+            for ( std::size_t g = 0 ; g < groups.size() && best < 0 ; g++ )
+            {
+                consider(g, untouched_ratio);
+            }
+        }
+
+        if ( best < 0 )
+        {
+            best = groups.size();
+            groups.emplace_back();
+            shared.push_back(0);
+        }
+
+        po_group& group = groups[best];
+
+        group.pos.push_back(iPo);
+
+        std::vector<int> added;
+        std::set_difference( supp.begin(), supp.end(), group.supp.begin(), group.supp.end(), std::back_inserter(added) );
+
+        for ( int v : added )
+        {
+            var_groups[v].push_back(best);
+        }
+
+        std::vector<int> merged;
+        std::set_union( group.supp.begin(), group.supp.end(), added.begin(), added.end(), std::back_inserter(merged) );
+        group.supp.swap(merged);
+    }
+
+    return groups;
+}
+
+std::vector<int> sorted_pos(Abc_Ntk_t* pNtk, PyObject* pypos)
+{
+    std::vector<int> pos;
+
+    for_iterator(pypos, [&](PyObject* item)
+    {
+        int iPo = Int_AsLong(item);
+
+        if ( iPo >= 0 && iPo < Abc_NtkPoNum(pNtk) )
+        {
+            pos.push_back(iPo);
+        }
+    });
+
+    std::sort( pos.begin(), pos.end() );
+    pos.erase( std::unique(pos.begin(), pos.end()), pos.end() );
+
+    return pos;
+}
+
+// the indices of the latches in the sequential support of the POs, in increasing order
+std::vector<int> cone_latches(Abc_Ntk_t* pNtk, const std::vector<int>& pos)
+{
+    std::vector<int> latch_index( Abc_NtkObjNumMax(pNtk), -1 );
+    std::vector<bool> kept( Abc_NtkLatchNum(pNtk), false );
+
+    Abc_Obj_t* pObj;
+    int i;
+
+    Abc_NtkForEachLatch( pNtk, pObj, i )
+    {
+        latch_index[ Abc_ObjId(pObj) ] = i;
+    }
+
+    std::vector<Abc_Obj_t*> stack;
+
+    for ( int iPo : pos )
+    {
+        stack.push_back( Abc_ObjFanin0( Abc_NtkPo(pNtk, iPo) ) );
+    }
+
+    Abc_NtkIncrementTravId( pNtk );
+
+    while ( !stack.empty() )
+    {
+        pObj = stack.back();
+        stack.pop_back();
+
+        if ( Abc_NodeIsTravIdCurrent(pObj) )
+        {
+            continue;
+        }
+
+        Abc_NodeSetTravIdCurrent(pObj);
+
+        if ( Abc_ObjIsBo(pObj) )
+        {
+            // through the latch to the driver of its input
+            Abc_Obj_t* pLatch = Abc_ObjFanin0(pObj);
+
+            kept[ latch_index[ Abc_ObjId(pLatch) ] ] = true;
+            stack.push_back( Abc_ObjFanin0( Abc_ObjFanin0(pLatch) ) );
+        }
+        else if ( Abc_ObjIsNode(pObj) )
+        {
+            stack.push_back( Abc_ObjFanin0(pObj) );
+            stack.push_back( Abc_ObjFanin1(pObj) );
+        }
+    }
+
+    std::vector<int> latches;
+
+    for ( std::size_t j = 0 ; j < kept.size() ; j++ )
+    {
+        if ( kept[j] )
+        {
+            latches.push_back(j);
+        }
+    }
+
+    return latches;
+}
+
+// A copy of a strashed network with only the selected POs (in increasing order), and the latches in
+// their sequential support, whose indices are returned in latches. All PIs are kept, so a cex of the
+// copy becomes a cex of the original network once the other latches are given their initial values
+// and its po is renumbered (see po_group_cex()).
+Abc_Ntk_t* dup_with_pos(Abc_Ntk_t* pNtk, const std::vector<int>& pos, std::vector<int>& latches)
+{
+    latches = cone_latches(pNtk, pos);
+
+    Abc_Ntk_t* pNew = Abc_NtkAlloc( ABC_NTK_STRASH, ABC_FUNC_AIG, 1 );
+    pNew->pName = Extra_UtilStrsav( pNtk->pName );
+
+    Abc_NtkCleanCopy( pNtk );
+    Abc_AigConst1(pNtk)->pCopy = Abc_AigConst1(pNew);
+
+    Abc_Obj_t* pObj;
+    int i;
+
+    Abc_NtkForEachPi( pNtk, pObj, i )
+    {
+        Abc_NtkDupObj( pNew, pObj, 1 );
+    }
+
+    std::vector<Abc_Obj_t*> roots;
+
+    for ( int iPo : pos )
+    {
+        pObj = Abc_NtkPo(pNtk, iPo);
+        Abc_NtkDupObj( pNew, pObj, 1 );
+        roots.push_back(pObj);
+    }
+
+    // the boxes of a strashed network are its latches
+    for ( int iLatch : latches )
+    {
+        pObj = Abc_NtkBox(pNtk, iLatch);
+        Abc_NtkDupBox( pNew, pObj, 1 );
+        pObj->pCopy->pData = pObj->pData;
+        roots.push_back( Abc_ObjFanin0(pObj) );
+    }
+
+    Vec_Ptr_t* vNodes = Abc_NtkDfsNodes( pNtk, roots.data(), roots.size() );
+
+    Vec_PtrForEachEntry( Abc_Obj_t*, vNodes, pObj, i )
+    {
+        pObj->pCopy = Abc_AigAnd( static_cast<Abc_Aig_t*>(pNew->pManFunc), Abc_ObjChild0Copy(pObj), Abc_ObjChild1Copy(pObj) );
+    }
+
+    Vec_PtrFree( vNodes );
+
+    for ( Abc_Obj_t* pCo : roots )
+    {
+        Abc_ObjAddFanin( pCo->pCopy, Abc_ObjChild0Copy(pCo) );
+    }
+
+    if ( !Abc_NtkCheck(pNew) )
+    {
+        Abc_NtkDelete(pNew);
+        return nullptr;
+    }
+
+    return pNew;
+}
+
+Abc_Ntk_t* current_strashed_network()
+{
+    Abc_Frame_t* pAbc = Abc_FrameGetGlobalFrame();
+    Abc_Ntk_t * pNtk = Abc_FrameReadNtk(pAbc);
+
+    if ( !pNtk || !Abc_NtkIsStrash(pNtk) )
+    {
+        return nullptr;
+    }
+
+    return pNtk;
+}
+
+} // unnamed namespace
+
+ref<PyObject> po_groups(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "overlap", "max_size", NULL };
+
+    double overlap = 0.5;
+    int max_size = 0;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "|di:po_groups", kwlist, &overlap, &max_size);
+
+    Abc_Ntk_t* pNtk = current_strashed_network();
+
+    if ( !pNtk )
+    {
+        return None;
+    }
+
+    std::vector<po_group> groups = group_pos(pNtk, overlap, max_size);
+
+    ref<PyObject> res = List_New( groups.size() );
+
+    for ( std::size_t i = 0 ; i < groups.size() ; i++ )
+    {
+        const std::vector<int>& pos = groups[i].pos;
+
+        ref<PyObject> pylist = List_New( pos.size() );
+
+        for ( std::size_t j = 0 ; j < pos.size() ; j++ )
+        {
+            List_SetItem( pylist, j, Int_FromLong(pos[j]) );
+        }
+
+        List_SetItem( res, i, pylist );
+    }
+
+    return res;
+}
+
+ref<PyObject> po_group_fingerprint(PyObject* pypos)
+{
+    Abc_Ntk_t* pNtk = current_strashed_network();
+
+    if ( !pNtk )
+    {
+        return None;
+    }
+
+    std::vector<int> latches;
+    Abc_Ntk_t* pNew = dup_with_pos( pNtk, sorted_pos(pNtk, pypos), latches );
+
+    if ( !pNew )
+    {
+        return None;
+    }
+
+    hash128 h = network_fingerprint( pNew, false );
+    Abc_NtkDelete( pNew );
+
+    return String_FromString( h.hex().c_str() );
+}
+
+ref<PyObject> po_group_latches(PyObject* pypos)
+{
+    Abc_Ntk_t* pNtk = current_strashed_network();
+
+    if ( !pNtk )
+    {
+        return None;
+    }
+
+    std::vector<int> latches = cone_latches( pNtk, sorted_pos(pNtk, pypos) );
+
+    ref<PyObject> res = List_New( latches.size() );
+
+    for ( std::size_t i = 0 ; i < latches.size() ; i++ )
+    {
+        List_SetItem( res, i, Int_FromLong(latches[i]) );
+    }
+
+    return res;
+}
+
+ref<PyObject> select_pos(PyObject* pypos)
+{
+    Abc_Ntk_t* pNtk = current_strashed_network();
+
+    if ( !pNtk )
+    {
+        return None;
+    }
+
+    std::vector<int> latches;
+    Abc_Ntk_t* pNew = dup_with_pos( pNtk, sorted_pos(pNtk, pypos), latches );
+
+    if ( !pNew )
+    {
+        return None;
+    }
+
+    Abc_Frame_t* pAbc = Abc_FrameGetGlobalFrame();
+
+    Abc_FrameReplaceCurrentNetwork( pAbc, pNew );
+    Abc_FrameClearVerifStatus( pAbc );
+
+    events_network_replaced();
+    events_changed();
+
+    ref<PyObject> res = List_New( latches.size() );
+
+    for ( std::size_t i = 0 ; i < latches.size() ; i++ )
+    {
+        List_SetItem( res, i, Int_FromLong(latches[i]) );
+    }
+
+    return res;
+}
+
+ref<PyObject> po_group_cex(PyObject* args)
+{
+    PyObject* pycex = nullptr;
+    PyObject* pylatches = nullptr;
+    int iPo = 0;
+
+    Arg_ParseTuple(args, "OOi:po_group_cex", &pycex, &pylatches, &iPo);
+
+    const Abc_Cex_t* pCex = cex::ensure(pycex).get();
+
+    std::vector<int> latches;
+
+    for_iterator(pylatches, [&](PyObject* item)
+    {
+        latches.push_back( Int_AsLong(item) );
+    });
+
+    Abc_Ntk_t* pNtk = current_strashed_network();
+
+    if ( !pNtk || iPo < 0 || iPo >= Abc_NtkPoNum(pNtk) || pCex->nPis != Abc_NtkPiNum(pNtk) || pCex->nRegs != static_cast<int>(latches.size()) )
+    {
+        return None;
+    }
+
+    for ( int iLatch : latches )
+    {
+        if ( iLatch < 0 || iLatch >= Abc_NtkLatchNum(pNtk) )
+        {
+            return None;
+        }
+    }
+
+    Abc_Cex_t* pNew = Abc_CexAlloc( Abc_NtkLatchNum(pNtk), pCex->nPis, pCex->iFrame + 1 );
+
+    pNew->iPo = iPo;
+    pNew->iFrame = pCex->iFrame;
+
+    // the latches outside the group do not affect its POs, they start from their initial values
+    Abc_Obj_t* pObj;
+    int i;
+
+    Abc_NtkForEachLatch( pNtk, pObj, i )
+    {
+        if ( Abc_LatchIsInit1(pObj) )
+        {
+            Abc_InfoSetBit( pNew->pData, i );
+        }
+    }
+
+    for ( std::size_t k = 0 ; k < latches.size() ; k++ )
+    {
+        if ( Abc_InfoHasBit( pCex->pData, k ) != Abc_InfoHasBit( pNew->pData, latches[k] ) )
+        {
+            Abc_InfoXorBit( pNew->pData, latches[k] );
+        }
+    }
+
+    for ( int b = 0 ; b < pCex->nPis * (pCex->iFrame + 1) ; b++ )
+    {
+        if ( Abc_InfoHasBit( pCex->pData, pCex->nRegs + b ) )
+        {
+            Abc_InfoSetBit( pNew->pData, pNew->nRegs + b );
+        }
+    }
+
+    // a script that changed the PIs or the latches of the group leaves a cex that does not fit
+    if ( !Abc_NtkIsValidCex( pNtk, pNew ) )
+    {
+        Abc_CexFree( pNew );
+        return None;
+    }
+
+    ref<PyObject> res = cex::build(pNew);
+    Abc_CexFree( pNew );
+
+    return res;
+}
+
+} // namespace pyabc
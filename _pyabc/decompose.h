@@ -0,0 +1,17 @@
+#ifndef pyabc_decompose__H
+#define pyabc_decompose__H
+
+#include "pyabc.h"
+
+namespace pyabc
+{
+
+ref<PyObject> po_groups(PyObject* args, PyObject* kwds);
+ref<PyObject> po_group_fingerprint(PyObject* pypos);
+ref<PyObject> po_group_latches(PyObject* pypos);
+ref<PyObject> select_pos(PyObject* pypos);
+ref<PyObject> po_group_cex(PyObject* args);
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_decompose__H
@@ -0,0 +1,430 @@
+#include "events.h"
+
+#include <base/abc/abc.h>
+#include <base/cmd/cmdInt.h>
+#include <base/main/main.h>
+#include <base/main/mainInt.h>
+#include <misc/util/utilCex.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace pyabc
+{
+
+namespace
+{
+
+enum
+{
+    event_network,
+    event_prob_status,
+    event_cex,
+    event_status_vector,
+    event_cex_vector,
+    event_count
+};
+
+const char* const event_names[event_count] = { "network", "prob_status", "cex", "status_vector", "cex_vector" };
+
+std::atomic<std::uint64_t> generations[event_count];
+
+// the signatures at the last check, only accessed by the thread running the commands
+std::uint64_t signatures[event_count];
+
+// bumped when pyabc replaces the network, and after each command that may change it in place
+std::uint64_t network_changes = 0;
+
+std::uint64_t mix(std::uint64_t h, std::uint64_t x)
+{
+    return (h ^ x) * 0x100000001b3ull;
+}
+
+std::uint64_t mix_ptr(std::uint64_t h, const void* p)
+{
+    return mix(h, reinterpret_cast<std::uintptr_t>(p));
+}
+
+std::uint64_t mix_cex(std::uint64_t h, const Abc_Cex_t* pCex)
+{
+    h = mix_ptr(h, pCex);
+
+    if ( pCex && pCex != reinterpret_cast<const Abc_Cex_t*>(1) )
+    {
+        h = mix(h, pCex->iPo);
+        h = mix(h, pCex->iFrame);
+    }
+
+    return h;
+}
+
+// The network is identified by generations rather than by its address, which may be reused: ABC
+// numbers each network that becomes current (nSteps), and network_changes counts the commands that
+// may have changed it in place. For the other parts, an object replaced by another is almost always
+// at a different address, as the new one is allocated before the old one is freed, and the sizes and
+// contents catch the in-place changes.
+std::uint64_t signature(int event)
+{
+    Abc_Frame_t* pAbc = Abc_FrameGetGlobalFrame();
+
+    std::uint64_t h = 0xcbf29ce484222325ull;
+
+    switch ( event )
+    {
+    case event_network:
+        {
+            Abc_Ntk_t* pNtk = Abc_FrameReadNtk(pAbc);
+
+            h = mix_ptr(h, pNtk);
+            h = mix(h, pAbc->nSteps);
+            h = mix(h, network_changes);
+
+            if ( pNtk )
+            {
+                h = mix(h, Abc_NtkObjNumMax(pNtk));
+                h = mix(h, Abc_NtkNodeNum(pNtk));
+                h = mix(h, Abc_NtkPiNum(pNtk));
+                h = mix(h, Abc_NtkPoNum(pNtk));
+                h = mix(h, Abc_NtkLatchNum(pNtk));
+            }
+        }
+        break;
+
+    case event_prob_status:
+        h = mix(h, Abc_FrameReadProbStatus(pAbc));
+        break;
+
+    case event_cex:
+        h = mix_cex(h, static_cast<Abc_Cex_t*>(Abc_FrameReadCex(pAbc)));
+        break;
+
+    case event_status_vector:
+        {
+            Vec_Int_t* vStatuses = Abc_FrameReadPoStatuses(pAbc);
+
+            h = mix_ptr(h, vStatuses);
+
+            if ( vStatuses )
+            {
+                int status, i;
+
+                h = mix(h, Vec_IntSize(vStatuses));
+
+                Vec_IntForEachEntry( vStatuses, status, i )
+                {
+                    h = mix(h, status);
+                }
+            }
+        }
+        break;
+
+    case event_cex_vector:
+        {
+            Vec_Ptr_t* vCexes = Abc_FrameReadCexVec(pAbc);
+
+            h = mix_ptr(h, vCexes);
+
+            if ( vCexes )
+            {
+                Abc_Cex_t* pCex;
+                int i;
+
+                h = mix(h, Vec_PtrSize(vCexes));
+
+                Vec_PtrForEachEntry( Abc_Cex_t*, vCexes, pCex, i )
+                {
+                    h = mix_cex(h, pCex);
+                }
+            }
+        }
+        break;
+    }
+
+    return h;
+}
+
+// whether a command is registered as changing the network, aliases and unknown names are assumed to
+bool command_changes_network(Abc_Frame_t* pAbc, const std::string& name)
+{
+    if ( name.empty() )
+    {
+        return false;
+    }
+
+    Abc_Command* pCommand;
+
+    if ( !st__lookup( pAbc->tCommands, name.c_str(), reinterpret_cast<char**>(&pCommand) ) )
+    {
+        return true;
+    }
+
+    return pCommand->fChange != 0;
+}
+
+// whether any command of a script may change the network, ABC splits it at the semicolons that are not quoted
+bool script_changes_network(Abc_Frame_t* pAbc, const char* script)
+{
+    std::string name;
+
+    bool quoted = false;
+    bool in_name = true;
+
+    for ( const char* p = script ; ; p++ )
+    {
+        if ( !*p || ( *p == ';' && !quoted ) )
+        {
+            if ( command_changes_network(pAbc, name) )
+            {
+                return true;
+            }
+
+            if ( !*p )
+            {
+                return false;
+            }
+
+            name.clear();
+            in_name = true;
+
+            continue;
+        }
+
+        if ( *p == '"' )
+        {
+            quoted = !quoted;
+        }
+
+        if ( !in_name )
+        {
+            continue;
+        }
+
+        if ( !isspace( static_cast<unsigned char>(*p) ) )
+        {
+            name.push_back(*p);
+        }
+        else if ( !name.empty() )
+        {
+            in_name = false;
+        }
+    }
+}
+
+struct subscriber
+{
+    ref<PyObject> callback;
+    unsigned mask;
+    std::uint64_t seen[event_count];
+};
+
+std::map<int, subscriber> subscribers;
+int next_subscriber_id = 1;
+
+// the changes not yet seen by a subscriber as a dict of event name -> generation, and mark them seen
+ref<PyObject> collect(subscriber& s, int& n)
+{
+    ref<PyObject> res = Dict_New();
+
+    n = 0;
+
+    for ( int i = 0 ; i < event_count ; i++ )
+    {
+        std::uint64_t g = generations[i].load(std::memory_order_relaxed);
+
+        if ( (s.mask & (1u << i)) && g != s.seen[i] )
+        {
+            Dict_SetItemString(res, event_names[i], Int_FromLong(g));
+            s.seen[i] = g;
+            n++;
+        }
+    }
+
+    return res;
+}
+
+unsigned parse_events(PyObject* pyevents)
+{
+    if ( !pyevents || pyevents == Py_None )
+    {
+        return (1u << event_count) - 1;
+    }
+
+    unsigned mask = 0;
+
+    for_iterator(pyevents, [&](PyObject* item)
+    {
+        const char* name = String_AsString(item);
+
+        for ( int i = 0 ; i < event_count ; i++ )
+        {
+            if ( strcmp(name, event_names[i]) == 0 )
+            {
+                mask |= 1u << i;
+                return;
+            }
+        }
+
+        PyErr_SetString(PyExc_ValueError, "unknown event name");
+        throw exception();
+    });
+
+    return mask;
+}
+
+} // unnamed namespace
+
+void events_init()
+{
+    for ( int i = 0 ; i < event_count ; i++ )
+    {
+        signatures[i] = signature(i);
+    }
+}
+
+void events_check()
+{
+    for ( int i = 0 ; i < event_count ; i++ )
+    {
+        std::uint64_t s = signature(i);
+
+        if ( s != signatures[i] )
+        {
+            signatures[i] = s;
+            generations[i].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void events_network_replaced()
+{
+    network_changes++;
+}
+
+void events_command_done(const char* cmd)
+{
+    if ( script_changes_network( Abc_FrameGetGlobalFrame(), cmd ) )
+    {
+        network_changes++;
+    }
+
+    events_check();
+}
+
+void events_deliver()
+{
+    // callbacks may subscribe or unsubscribe, walk a copy of the ids
+    std::vector<int> ids;
+
+    for ( auto& kv : subscribers )
+    {
+        if ( kv.second.callback )
+        {
+            ids.push_back(kv.first);
+        }
+    }
+
+    for ( int id : ids )
+    {
+        auto it = subscribers.find(id);
+
+        if ( it == subscribers.end() )
+        {
+            continue;
+        }
+
+        int n;
+
+        ref<PyObject> callback = it->second.callback;
+        ref<PyObject> changes = collect(it->second, n);
+
+        if ( n == 0 )
+        {
+            continue;
+        }
+
+        try
+        {
+            Object_CallFunction(callback, "(O)", changes.get());
+        }
+        catch(py::exception&)
+        {
+            PyErr_Print();
+        }
+    }
+}
+
+void events_changed()
+{
+    events_check();
+    events_deliver();
+}
+
+ref<PyObject> event_generations()
+{
+    ref<PyObject> res = Dict_New();
+
+    for ( int i = 0 ; i < event_count ; i++ )
+    {
+        Dict_SetItemString(res, event_names[i], Int_FromLong(generations[i].load(std::memory_order_relaxed)));
+    }
+
+    return res;
+}
+
+ref<PyObject> event_subscribe(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "callback", "events", NULL };
+
+    PyObject* pycallback = nullptr;
+    PyObject* pyevents = nullptr;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "|OO:event_subscribe", kwlist, &pycallback, &pyevents);
+
+    subscriber s;
+
+    if ( pycallback && pycallback != Py_None )
+    {
+        s.callback = borrow(pycallback);
+    }
+
+    s.mask = parse_events(pyevents);
+
+    // only the changes after the subscription are reported
+    for ( int i = 0 ; i < event_count ; i++ )
+    {
+        s.seen[i] = generations[i].load(std::memory_order_relaxed);
+    }
+
+    int id = next_subscriber_id++;
+    subscribers[id] = s;
+
+    return Int_FromLong(id);
+}
+
+ref<PyObject> event_unsubscribe(PyObject* pyid)
+{
+    return Bool_FromLong( subscribers.erase( Int_AsLong(pyid) ) > 0 );
+}
+
+ref<PyObject> event_poll(PyObject* pyid)
+{
+    auto it = subscribers.find( Int_AsLong(pyid) );
+
+    if ( it == subscribers.end() )
+    {
+        return None;
+    }
+
+    // changes made by direct ABC calls since the last command are picked up here
+    events_check();
+
+    int n;
+    return collect(it->second, n);
+}
+
+} // namespace pyabc
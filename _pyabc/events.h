@@ -0,0 +1,48 @@
+#ifndef pyabc_events__H
+#define pyabc_events__H
+
+#include "pyabc.h"
+
+namespace pyabc
+{
+
+// Generation numbers of the parts of the ABC frame that Python code caches: the current network,
+// prob_status, the current cex, the status vector and the cex vector. events_check() compares a
+// signature of each part with the previous one, and bumps the generation of the parts that changed.
+// The signature of the network is made of generation counters: the number of networks that became
+// current, and the number of commands registered as changing the network that were executed. The
+// other parts are signed by the object and its sizes or contents. events_check() is called after
+// every command executed by execute_command(), and by the pyabc functions that replace parts of the
+// frame.
+//
+// Subscribers are notified in batches, when control returns to Python: a subscriber sees each
+// changed part once, with its latest generation, however many times it changed in between.
+
+// record the initial signatures
+void events_init();
+
+// bump the generations of the parts that changed, safe to call without the GIL
+void events_check();
+
+// count a change of the current network made outside of a command, by the pyabc functions that replace
+// it, safe to call without the GIL
+void events_network_replaced();
+
+// count a script executed by execute_command() as a change of the network if any of its commands may
+// change it, then events_check()
+void events_command_done(const char* cmd);
+
+// notify the subscribers with a callback of the changes they have not seen, called with the GIL
+void events_deliver();
+
+// events_check() followed by events_deliver(), for the functions called from Python
+void events_changed();
+
+ref<PyObject> event_generations();
+ref<PyObject> event_subscribe(PyObject* args, PyObject* kwds);
+ref<PyObject> event_unsubscribe(PyObject* pyid);
+ref<PyObject> event_poll(PyObject* pyid);
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_events__H
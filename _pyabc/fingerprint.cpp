@@ -0,0 +1,225 @@
+#include "fingerprint.h"
+
+#include <base/abc/abc.h>
+#include <base/main/main.h>
+
+#include <utility>
+#include <vector>
+
+#include <stdio.h>
+
+namespace pyabc
+{
+
+namespace
+{
+
+inline std::uint64_t mix64(std::uint64_t x)
+{
+    // the splitmix64 finalizer
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+inline hash128 combine(hash128 h, std::uint64_t lo, std::uint64_t hi)
+{
+    h.lo = mix64( h.lo ^ mix64(lo + 0x9e3779b97f4a7c15ULL) );
+    h.hi = mix64( h.hi + mix64(hi ^ 0xc2b2ae3d27d4eb4fULL) );
+    return h;
+}
+
+inline hash128 combine(hash128 h, const hash128& v)
+{
+    return combine(h, v.lo, v.hi);
+}
+
+inline hash128 seed(std::uint64_t kind, std::uint64_t index)
+{
+    hash128 h = { kind, ~kind };
+    return combine(h, index, index);
+}
+
+inline hash128 complement(hash128 h, int fCompl)
+{
+    if ( fCompl )
+    {
+        h.lo = ~h.lo;
+        h.hi = mix64(h.hi);
+    }
+
+    return h;
+}
+
+inline bool operator<(const hash128& a, const hash128& b)
+{
+    return a.lo < b.lo || ( a.lo == b.lo && a.hi < b.hi );
+}
+
+inline bool operator!=(const hash128& a, const hash128& b)
+{
+    return a.lo != b.lo || a.hi != b.hi;
+}
+
+enum
+{
+    KIND_CONST = 1,
+    KIND_PI,
+    KIND_LATCH,
+    KIND_AND,
+    KIND_PO,
+    KIND_NEXT,
+    KIND_NETWORK
+};
+
+// per-object state kept between incremental calls
+struct node_memo
+{
+    int fanin0;
+    int fanin1;
+    hash128 hash;
+    bool changed;
+};
+
+std::vector<node_memo> memo;
+
+inline hash128 fanin_hash(Abc_Obj_t* pObj, int i)
+{
+    Abc_Obj_t* pFanin = Abc_ObjFanin(pObj, i);
+    return complement( memo[Abc_ObjId(pFanin)].hash, Abc_ObjFaninC(pObj, i) );
+}
+
+inline int fanin_lit(Abc_Obj_t* pObj, int i)
+{
+    return 2 * Abc_ObjId(Abc_ObjFanin(pObj, i)) + Abc_ObjFaninC(pObj, i);
+}
+
+void set_leaf(Abc_Obj_t* pObj, const hash128& h, bool fIncremental)
+{
+    node_memo& m = memo[Abc_ObjId(pObj)];
+
+    m.changed = !fIncremental || m.fanin0 != -1 || m.hash != h;
+    m.fanin0 = -1;
+    m.fanin1 = -1;
+    m.hash = h;
+}
+
+} // unnamed namespace
+
+std::string hash128::hex() const
+{
+    char buf[33];
+    snprintf(buf, sizeof(buf), "%016llx%016llx", static_cast<unsigned long long>(hi), static_cast<unsigned long long>(lo));
+    return buf;
+}
+
+hash128 network_fingerprint(Abc_Ntk_t* pNtk, bool fIncremental)
+{
+    int nObjs = Abc_NtkObjNumMax(pNtk);
+
+    if ( !fIncremental )
+    {
+        memo.clear();
+    }
+
+    node_memo empty = { -2, -2, { 0, 0 }, true };
+    memo.resize(nObjs, empty);
+
+    Abc_Obj_t* pObj;
+    int i;
+
+    set_leaf( Abc_AigConst1(pNtk), seed(KIND_CONST, 0), fIncremental );
+
+    Abc_NtkForEachPi( pNtk, pObj, i )
+    {
+        set_leaf( pObj, seed(KIND_PI, i), fIncremental );
+    }
+
+    Abc_NtkForEachLatch( pNtk, pObj, i )
+    {
+        set_leaf( Abc_ObjFanout0(pObj), seed(KIND_LATCH, i), fIncremental );
+    }
+
+    // a single pass over the AND nodes in topological order
+
+    Vec_Ptr_t* vNodes = Abc_AigDfs( pNtk, 1, 0 );
+
+    Vec_PtrForEachEntry( Abc_Obj_t*, vNodes, pObj, i )
+    {
+        node_memo& m = memo[Abc_ObjId(pObj)];
+
+        int fanin0 = fanin_lit(pObj, 0);
+        int fanin1 = fanin_lit(pObj, 1);
+
+        bool fReuse = fIncremental &&
+            m.fanin0 == fanin0 && m.fanin1 == fanin1 &&
+            !memo[Abc_ObjFaninId0(pObj)].changed &&
+            !memo[Abc_ObjFaninId1(pObj)].changed;
+
+        if ( fReuse )
+        {
+            m.changed = false;
+            continue;
+        }
+
+        // the hash of an AND is independent of the order of its fanins
+
+        hash128 h0 = fanin_hash(pObj, 0);
+        hash128 h1 = fanin_hash(pObj, 1);
+
+        if ( h1 < h0 )
+        {
+            std::swap(h0, h1);
+        }
+
+        hash128 h = combine( combine( seed(KIND_AND, 0), h0 ), h1 );
+
+        m.changed = m.hash != h;
+        m.fanin0 = fanin0;
+        m.fanin1 = fanin1;
+        m.hash = h;
+    }
+
+    Vec_PtrFree( vNodes );
+
+    hash128 res = seed( KIND_NETWORK, 0 );
+    res = combine( res, Abc_NtkPiNum(pNtk), Abc_NtkPoNum(pNtk) );
+    res = combine( res, Abc_NtkLatchNum(pNtk), 0 );
+
+    Abc_NtkForEachPo( pNtk, pObj, i )
+    {
+        res = combine( res, combine( seed(KIND_PO, i), fanin_hash(pObj, 0) ) );
+    }
+
+    Abc_NtkForEachLatch( pNtk, pObj, i )
+    {
+        int init = Abc_LatchIsInit0(pObj) ? 0 : Abc_LatchIsInit1(pObj) ? 1 : 2;
+        res = combine( res, combine( seed(KIND_NEXT, init), fanin_hash(Abc_ObjFanin0(pObj), 0) ) );
+    }
+
+    return res;
+}
+
+ref<PyObject> fingerprint(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "incremental", NULL };
+
+    int fIncremental = 0;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "|i:fingerprint", kwlist, &fIncremental);
+
+    Abc_Frame_t* pAbc = Abc_FrameGetGlobalFrame();
+    Abc_Ntk_t * pNtk = Abc_FrameReadNtk(pAbc);
+
+    if ( !pNtk || !Abc_NtkIsStrash(pNtk) )
+    {
+        return None;
+    }
+
+    return String_FromString( network_fingerprint(pNtk, fIncremental).hex().c_str() );
+}
+
+} // namespace pyabc
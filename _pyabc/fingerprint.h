@@ -0,0 +1,33 @@
+#ifndef pyabc_fingerprint__H
+#define pyabc_fingerprint__H
+
+#include "pyabc.h"
+
+#include <cstdint>
+#include <string>
+
+ABC_NAMESPACE_HEADER_START
+typedef struct Abc_Ntk_t_ Abc_Ntk_t;
+ABC_NAMESPACE_HEADER_END
+
+namespace pyabc
+{
+
+struct hash128
+{
+    std::uint64_t lo;
+    std::uint64_t hi;
+
+    std::string hex() const;
+};
+
+// a structural hash of a strashed network, independent of node numbering but sensitive to the order
+// of PIs, POs and latches. With fIncremental, reuse the node hashes of the previous call whenever
+// the fanins of a node and their hashes did not change.
+hash128 network_fingerprint(Abc_Ntk_t* pNtk, bool fIncremental);
+
+ref<PyObject> fingerprint(PyObject* args, PyObject* kwds);
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_fingerprint__H
@@ -0,0 +1,507 @@
+#include "journal.h"
+#include "command.h"
+#include "snapshot.h"
+
+#include <base/abc/abc.h>
+#include <base/cmd/cmd.h>
+#include <base/main/main.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace pyabc
+{
+
+namespace
+{
+
+// layout: [magic][u32 size][snapshot] followed by records, each a record_header followed by a body
+// of header.size bytes. All fields are native-endian. Readers skip the kinds they do not know.
+
+const char journal_magic[8] = { 'P', 'Y', 'A', 'B', 'C', 'J', 'R', '1' };
+
+enum : std::uint8_t
+{
+    kind_command = 1,           // command_body followed by the command line
+    kind_python_command = 2,    // command_body followed by the arguments, separated by spaces
+    kind_frame_done = 3,        // frame_body
+};
+
+struct record_header
+{
+    std::uint8_t kind;
+    std::uint8_t depth;         // 0 for the top-level commands
+    std::uint16_t reserved;
+    std::uint32_t size;
+    std::int64_t time_ns;       // start of the event, since the start of the journal
+};
+
+// the network sizes are taken after the command, -1 without a network, n_ands is -1 if it is not strashed
+struct command_body
+{
+    std::int64_t duration_ns;
+    std::int32_t rc;
+    std::int32_t n_pis;
+    std::int32_t n_pos;
+    std::int32_t n_latches;
+    std::int32_t n_ands;
+    std::int32_t reserved;
+};
+
+struct frame_body
+{
+    std::int32_t frame;
+    std::int32_t po;
+    std::int32_t status;
+};
+
+struct journal_state
+{
+    std::mutex lock;            // frame-done events may come from the threads of an engine
+    FILE* f = nullptr;
+    int base_depth = 0;         // the command depth at which the journal was started
+    std::chrono::steady_clock::time_point start;
+};
+
+journal_state journal;
+
+// frame-done events since the start of the current replay step
+std::atomic<int> replay_frames{ 0 };
+
+void network_sizes(command_body& b)
+{
+    Abc_Ntk_t* pNtk = Abc_FrameReadNtk( Abc_FrameGetGlobalFrame() );
+
+    b.n_pis = pNtk ? Abc_NtkPiNum(pNtk) : -1;
+    b.n_pos = pNtk ? Abc_NtkPoNum(pNtk) : -1;
+    b.n_latches = pNtk ? Abc_NtkLatchNum(pNtk) : -1;
+    b.n_ands = pNtk && Abc_NtkIsStrash(pNtk) ? Abc_NtkNodeNum(pNtk) : -1;
+}
+
+void write_record(std::uint8_t kind, int depth, std::chrono::steady_clock::time_point time, const void* body, std::size_t body_size, const std::string& payload)
+{
+    std::lock_guard<std::mutex> guard(journal.lock);
+
+    depth -= journal.base_depth;
+
+    // events that enclose the journal, such as the end of the command that started it
+    if ( !journal.f || depth < 0 )
+    {
+        return;
+    }
+
+    record_header h;
+
+    h.kind = kind;
+    h.depth = depth < 255 ? depth : 255;
+    h.reserved = 0;
+    h.size = body_size + payload.size();
+    h.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time - journal.start).count();
+
+    fwrite(&h, sizeof(h), 1, journal.f);
+    fwrite(body, body_size, 1, journal.f);
+    fwrite(payload.data(), 1, payload.size(), journal.f);
+
+    // a crash keeps every completed top-level command
+    if ( kind == kind_command && depth == 0 )
+    {
+        fflush(journal.f);
+    }
+}
+
+void close_journal()
+{
+    std::lock_guard<std::mutex> guard(journal.lock);
+
+    if ( journal.f )
+    {
+        fclose(journal.f);
+        journal.f = nullptr;
+    }
+}
+
+// start a journal with a snapshot of the current state, replacing the journal in progress if any
+bool open_journal(const char* path, int base_depth)
+{
+    close_journal();
+
+    std::string snapshot;
+
+    if ( !save_snapshot(snapshot) )
+    {
+        return false;
+    }
+
+    FILE* f = fopen(path, "wbe");
+
+    if ( !f )
+    {
+        return false;
+    }
+
+    std::uint32_t size = snapshot.size();
+
+    bool ok = fwrite(journal_magic, sizeof(journal_magic), 1, f) == 1 && fwrite(&size, sizeof(size), 1, f) == 1 && fwrite(snapshot.data(), 1, size, f) == size && fflush(f) == 0;
+
+    if ( !ok )
+    {
+        fclose(f);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(journal.lock);
+
+    journal.f = f;
+    journal.base_depth = base_depth;
+    journal.start = std::chrono::steady_clock::now();
+
+    return true;
+}
+
+// flush before fork() so that the child does not write the parent's buffer again, and stop
+// recording in the child
+void atfork_prepare_handler()
+{
+    journal.lock.lock();
+
+    if ( journal.f )
+    {
+        fflush(journal.f);
+    }
+}
+
+void atfork_parent_handler()
+{
+    journal.lock.unlock();
+}
+
+void atfork_child_handler()
+{
+    if ( journal.f )
+    {
+        fclose(journal.f);
+        journal.f = nullptr;
+    }
+
+    journal.lock.unlock();
+}
+
+struct replay_step
+{
+    std::string cmd;
+    command_body recorded;
+    int frames;
+};
+
+bool read_journal(const char* path, std::string& buf, std::string& snapshot, std::vector<replay_step>& steps)
+{
+    FILE* f = fopen(path, "rb");
+
+    if ( !f )
+    {
+        return false;
+    }
+
+    char chunk[1 << 16];
+    std::size_t n;
+
+    while ( (n = fread(chunk, 1, sizeof(chunk), f)) > 0 )
+    {
+        buf.append(chunk, n);
+    }
+
+    bool ok = !ferror(f);
+    fclose(f);
+
+    const char* data = buf.data();
+    const char* end = data + buf.size();
+
+    std::uint32_t snapshot_size;
+
+    if ( !ok || buf.size() < sizeof(journal_magic) + sizeof(snapshot_size) || memcmp(data, journal_magic, sizeof(journal_magic)) != 0 )
+    {
+        return false;
+    }
+
+    data += sizeof(journal_magic);
+
+    memcpy(&snapshot_size, data, sizeof(snapshot_size));
+    data += sizeof(snapshot_size);
+
+    if ( static_cast<std::size_t>(end - data) < snapshot_size )
+    {
+        return false;
+    }
+
+    snapshot.assign(data, snapshot_size);
+    data += snapshot_size;
+
+    int frames = 0;
+
+    // a journal cut short by a crash ends with a partial record, which is ignored
+    while ( end - data >= static_cast<std::ptrdiff_t>(sizeof(record_header)) )
+    {
+        record_header h;
+        memcpy(&h, data, sizeof(h));
+        data += sizeof(h);
+
+        if ( static_cast<std::size_t>(end - data) < h.size )
+        {
+            break;
+        }
+
+        if ( h.kind == kind_frame_done )
+        {
+            frames++;
+        }
+        else if ( h.kind == kind_command && h.depth == 0 && h.size >= sizeof(command_body) )
+        {
+            replay_step step;
+
+            memcpy(&step.recorded, data, sizeof(command_body));
+            step.cmd.assign(data + sizeof(command_body), h.size - sizeof(command_body));
+            step.frames = frames;
+
+            steps.push_back(step);
+
+            frames = 0;
+        }
+
+        data += h.size;
+    }
+
+    return true;
+}
+
+double to_ms(std::int64_t ns)
+{
+    return ns / 1e6;
+}
+
+int abc_command_replay(Abc_Frame_t* pAbc, int argc, char** argv)
+{
+    const char* write_path = nullptr;
+    int i = 1;
+
+    if ( argc > 2 && strcmp(argv[1], "-w") == 0 )
+    {
+        write_path = argv[2];
+        i = 3;
+    }
+
+    if ( argc != i + 1 || argv[i][0] == '-' )
+    {
+        fprintf( stderr, "usage: replay [-w <file>] <journal>\n" );
+        fprintf( stderr, "\t         re-executes the top-level commands of a journal on its initial network,\n" );
+        fprintf( stderr, "\t         and reports the time of each command against the recording\n" );
+        fprintf( stderr, "\t-w file: record the replay into a new journal, replacing the journal in progress\n" );
+        return 1;
+    }
+
+    std::string buf;
+    std::string snapshot;
+    std::vector<replay_step> steps;
+
+    if ( !read_journal(argv[i], buf, snapshot, steps) )
+    {
+        fprintf( stderr, "replay: cannot read journal \"%s\"\n", argv[i] );
+        return 1;
+    }
+
+    if ( !restore_snapshot(snapshot.data(), snapshot.size()) )
+    {
+        fprintf( stderr, "replay: cannot restore the initial state of \"%s\"\n", argv[i] );
+        return 1;
+    }
+
+    if ( write_path && !open_journal(write_path, execute_command_depth()) )
+    {
+        fprintf( stderr, "replay: cannot write journal \"%s\"\n", write_path );
+        return 1;
+    }
+
+    printf( "%5s %12s %12s %12s %8s %15s  %s\n", "step", "recorded ms", "replay ms", "delta ms", "ratio", "frames", "command" );
+
+    std::int64_t total_recorded = 0;
+    std::int64_t total_replay = 0;
+    int n_diverged = 0;
+
+    for ( std::size_t k = 0 ; k < steps.size() ; k++ )
+    {
+        const replay_step& step = steps[k];
+
+        replay_frames = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        int rc = execute_command( step.cmd.c_str() );
+        std::int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        command_body replayed;
+        network_sizes(replayed);
+
+        const command_body& r = step.recorded;
+
+        // a different outcome makes the timing of the following steps meaningless to compare
+        bool diverged = rc != r.rc || replayed.n_pis != r.n_pis || replayed.n_pos != r.n_pos || replayed.n_latches != r.n_latches || replayed.n_ands != r.n_ands;
+
+        n_diverged += diverged;
+
+        total_recorded += r.duration_ns;
+        total_replay += elapsed;
+
+        printf( "%5d %12.3f %12.3f %+12.3f %7.2fx%c %7d/%-7d  %s\n",
+            static_cast<int>(k + 1),
+            to_ms(r.duration_ns),
+            to_ms(elapsed),
+            to_ms(elapsed - r.duration_ns),
+            r.duration_ns > 0 ? static_cast<double>(elapsed) / r.duration_ns : 0.0,
+            diverged ? '*' : ' ',
+            step.frames,
+            replay_frames.load(),
+            step.cmd.c_str() );
+    }
+
+    printf( "%5s %12.3f %12.3f %+12.3f %7.2fx\n",
+        "total",
+        to_ms(total_recorded),
+        to_ms(total_replay),
+        to_ms(total_replay - total_recorded),
+        total_recorded > 0 ? static_cast<double>(total_replay) / total_recorded : 0.0 );
+
+    if ( n_diverged > 0 )
+    {
+        printf( "* %d step(s) returned a different code or network size than in the recording\n", n_diverged );
+    }
+
+    if ( write_path )
+    {
+        close_journal();
+    }
+
+    return 0;
+}
+
+} // unnamed namespace
+
+void journal_init()
+{
+    Cmd_CommandAdd( Abc_FrameGetGlobalFrame(), "Python", "replay", abc_command_replay, 1 );
+
+    pthread_atfork(atfork_prepare_handler, atfork_parent_handler, atfork_child_handler);
+
+    const char* env = getenv("PYABC_JOURNAL");
+
+    if ( !env || !*env )
+    {
+        return;
+    }
+
+    std::string path = env;
+    std::string pid = std::to_string(getpid());
+
+    for ( std::size_t i = path.find("%p") ; i != std::string::npos ; i = path.find("%p", i + pid.size()) )
+    {
+        path.replace(i, 2, pid);
+    }
+
+    open_journal(path.c_str(), 0);
+}
+
+void journal_command_done(const char* cmd, int depth, std::chrono::steady_clock::time_point start, int rc)
+{
+    if ( !journal.f )
+    {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+
+    command_body b;
+
+    b.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+    b.rc = rc;
+    b.reserved = 0;
+    network_sizes(b);
+
+    write_record(kind_command, depth, start, &b, sizeof(b), cmd);
+}
+
+void journal_python_command_done(int argc, char** argv, int depth, std::chrono::steady_clock::time_point start, int rc)
+{
+    if ( !journal.f )
+    {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+
+    command_body b;
+
+    b.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+    b.rc = rc;
+    b.reserved = 0;
+    network_sizes(b);
+
+    std::string args;
+
+    for ( int i = 0 ; i < argc ; i++ )
+    {
+        if ( i > 0 )
+        {
+            args.push_back(' ');
+        }
+
+        args.append(argv[i]);
+    }
+
+    write_record(kind_python_command, depth, start, &b, sizeof(b), args);
+}
+
+void journal_frame_done(int frame, int po, int status, int depth)
+{
+    replay_frames++;
+
+    if ( !journal.f )
+    {
+        return;
+    }
+
+    frame_body b = { frame, po, status };
+
+    write_record(kind_frame_done, depth, std::chrono::steady_clock::now(), &b, sizeof(b), std::string());
+}
+
+ref<PyObject> journal_start(PyObject* pypath)
+{
+    const char* path = String_AsString(pypath);
+
+    bool ok;
+
+    {
+        enable_threads scope;
+        ok = open_journal(path, execute_command_depth());
+    }
+
+    return Bool_FromLong(ok);
+}
+
+ref<PyObject> journal_stop()
+{
+    {
+        enable_threads scope;
+        close_journal();
+    }
+
+    return None;
+}
+
+} // namespace pyabc
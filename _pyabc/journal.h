@@ -0,0 +1,29 @@
+#ifndef pyabc_journal__H
+#define pyabc_journal__H
+
+#include "pyabc.h"
+
+#include <chrono>
+
+namespace pyabc
+{
+
+// A journal records the commands executed by execute_command(), the invocations of commands
+// implemented in Python and the frame-done events, with timestamps and the size of the network
+// after each command. It starts with a snapshot of the state, so that the replay command can
+// re-execute the top-level commands on the same initial network and compare their timing.
+
+// register the replay command, and start a journal if PYABC_JOURNAL names a file (%p is the pid)
+void journal_init();
+
+// called by command.cpp, depth is the nesting of execute_command() of the event
+void journal_command_done(const char* cmd, int depth, std::chrono::steady_clock::time_point start, int rc);
+void journal_python_command_done(int argc, char** argv, int depth, std::chrono::steady_clock::time_point start, int rc);
+void journal_frame_done(int frame, int po, int status, int depth);
+
+ref<PyObject> journal_start(PyObject* pypath);
+ref<PyObject> journal_stop();
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_journal__H
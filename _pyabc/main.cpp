@@ -2,6 +2,10 @@
 
 #include <misc/util/abc_global.h>
 
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
 ABC_NAMESPACE_HEADER_START
 
 int Abc_RealMain(int argc, char *argv[]);
@@ -13,8 +17,57 @@ namespace pyzz
 void zz_init();
 }
 
+namespace
+{
+
+// with PYABC_STARTUP_TIMING set, report how long each startup phase took on stderr
+class startup_timer
+{
+public:
+
+    startup_timer() :
+        _enabled( getenv("PYABC_STARTUP_TIMING") && strcmp(getenv("PYABC_STARTUP_TIMING"), "0") != 0 ),
+        _start( std::chrono::steady_clock::now() ),
+        _last( _start )
+    {
+    }
+
+    void phase(const char* name)
+    {
+        if ( !_enabled )
+        {
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        fprintf( stderr, "pyabc startup: %-16s %8.3f ms\n", name, std::chrono::duration<double, std::milli>(now - _last).count() );
+        _last = now;
+    }
+
+    void total()
+    {
+        if ( !_enabled )
+        {
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        fprintf( stderr, "pyabc startup: %-16s %8.3f ms\n", "total", std::chrono::duration<double, std::milli>(now - _start).count() );
+    }
+
+private:
+
+    bool _enabled;
+    std::chrono::steady_clock::time_point _start;
+    std::chrono::steady_clock::time_point _last;
+};
+
+} // unnamed namespace
+
 int main(int argc, char *argv[])
 {
+    startup_timer timer;
+
     Py_NoSiteFlag = 1;
 
     PyImport_AppendInittab("_pyabc", pyabc::init);
@@ -22,9 +75,15 @@ int main(int argc, char *argv[])
 
     py::initialize interpreter(argv[0]);
 
+    timer.phase("interpreter");
+
     try
     {
+        py::Import_ImportModule("_pyabc");
+        timer.phase("import _pyabc");
+
         py::Import_ImportModule("pyabc");
+        timer.phase("import pyabc");
     }
     catch(py::exception&)
     {
@@ -32,5 +91,7 @@ int main(int argc, char *argv[])
         PyErr_Print();
     }
 
+    timer.total();
+
     return ABC_NAMESPACE_PREFIX Abc_RealMain(argc, argv);
 }
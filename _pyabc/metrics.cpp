@@ -0,0 +1,226 @@
+#include "metrics.h"
+#include "util.h"
+
+#include <base/abc/abc.h>
+#include <base/main/main.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace pyabc
+{
+
+namespace
+{
+
+// The page has a fixed layout, read by pyabc/metrics.py: a 16-byte header followed by 64-bit counters,
+// all native-endian. Writers use relaxed atomics, readers see each counter atomically but not a
+// consistent set of counters.
+
+const std::uint32_t metrics_magic = 0x4d434241; // "ABCM"
+const std::uint32_t metrics_version = 2;
+
+struct metrics_page
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::int32_t pid;
+    std::uint32_t reserved;
+
+    std::atomic<std::uint64_t> commands;
+    std::atomic<std::uint64_t> abc_ns;          // time spent inside run_command()
+    std::atomic<std::uint64_t> forks;
+    std::atomic<std::uint64_t> split_bytes;     // bytes received from split workers
+    std::atomic<std::int64_t> n_pis;
+    std::atomic<std::int64_t> n_pos;
+    std::atomic<std::int64_t> n_latches;
+    std::atomic<std::int64_t> n_ands;
+    std::atomic<std::uint64_t> rss_bytes;
+    std::atomic<std::uint64_t> updated_ns;      // CLOCK_REALTIME of the last update
+    std::atomic<std::uint64_t> split_teardowns; // split jobs torn down before they finished
+    std::atomic<std::uint64_t> split_teardown_ns;
+};
+
+static_assert( sizeof(std::atomic<std::uint64_t>) == sizeof(std::uint64_t), "64-bit atomics must be plain words to be shared" );
+
+// until a page is published, and in forked children, the counters go to a private page
+metrics_page private_page;
+metrics_page* page = &private_page;
+
+std::string page_path;
+
+// RSS is read from /proc, at most once per interval
+const std::int64_t rss_interval_ns = 1000000000;
+std::int64_t rss_sampled_ns = 0;
+
+std::uint64_t realtime_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+}
+
+void atfork_parent_handler()
+{
+    page->forks.fetch_add(1, std::memory_order_relaxed);
+}
+
+void atfork_child_handler()
+{
+    // children must not write to the page of their parent
+
+    if ( page != &private_page )
+    {
+        page = &private_page;
+        page_path.clear();
+    }
+}
+
+void remove_page()
+{
+    if ( !page_path.empty() )
+    {
+        unlink( page_path.c_str() );
+    }
+}
+
+std::string expand_path(const char* env)
+{
+    std::string pid = std::to_string(getpid());
+
+    if ( strcmp(env, "1") == 0 )
+    {
+        return "/dev/shm/pyabc-metrics." + pid;
+    }
+
+    std::string path = env;
+
+    for ( std::size_t i = path.find("%p") ; i != std::string::npos ; i = path.find("%p", i + pid.size()) )
+    {
+        path.replace(i, 2, pid);
+    }
+
+    return path;
+}
+
+} // unnamed namespace
+
+void metrics_init()
+{
+    const char* env = getenv("PYABC_METRICS");
+
+    if ( !env || !*env || strcmp(env, "0") == 0 )
+    {
+        return;
+    }
+
+    std::string path = expand_path(env);
+
+    int fd = open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+
+    if ( fd < 0 )
+    {
+        return;
+    }
+
+    void* p = MAP_FAILED;
+
+    if ( ftruncate(fd, sizeof(metrics_page)) == 0 )
+    {
+        p = mmap( nullptr, sizeof(metrics_page), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    }
+
+    close(fd);
+
+    if ( p == MAP_FAILED )
+    {
+        unlink( path.c_str() );
+        return;
+    }
+
+    // the file is zero-filled, which is a valid state for the counters
+    page = static_cast<metrics_page*>(p);
+
+    page->version = metrics_version;
+    page->pid = getpid();
+    page->n_pis.store(-1, std::memory_order_relaxed);
+    page->n_pos.store(-1, std::memory_order_relaxed);
+    page->n_latches.store(-1, std::memory_order_relaxed);
+    page->n_ands.store(-1, std::memory_order_relaxed);
+    page->rss_bytes.store(rss_bytes(), std::memory_order_relaxed);
+    page->updated_ns.store(realtime_ns(), std::memory_order_relaxed);
+
+    // readers check the magic number last
+    std::atomic_thread_fence(std::memory_order_release);
+    page->magic = metrics_magic;
+
+    page_path = path;
+
+    pthread_atfork(nullptr, atfork_parent_handler, atfork_child_handler);
+    atexit(remove_page);
+}
+
+void metrics_command_done(std::int64_t elapsed_ns)
+{
+    if ( page == &private_page )
+    {
+        return;
+    }
+
+    page->commands.fetch_add(1, std::memory_order_relaxed);
+    page->abc_ns.fetch_add(elapsed_ns, std::memory_order_relaxed);
+
+    Abc_Ntk_t* pNtk = Abc_FrameReadNtk( Abc_FrameGetGlobalFrame() );
+
+    page->n_pis.store( pNtk ? Abc_NtkPiNum(pNtk) : -1, std::memory_order_relaxed );
+    page->n_pos.store( pNtk ? Abc_NtkPoNum(pNtk) : -1, std::memory_order_relaxed );
+    page->n_latches.store( pNtk ? Abc_NtkLatchNum(pNtk) : -1, std::memory_order_relaxed );
+    page->n_ands.store( pNtk && Abc_NtkIsStrash(pNtk) ? Abc_NtkNodeNum(pNtk) : -1, std::memory_order_relaxed );
+
+    std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+
+    if ( now - rss_sampled_ns >= rss_interval_ns )
+    {
+        rss_sampled_ns = now;
+        page->rss_bytes.store( rss_bytes(), std::memory_order_relaxed );
+    }
+
+    page->updated_ns.store( realtime_ns(), std::memory_order_relaxed );
+}
+
+ref<PyObject> metrics_path()
+{
+    if ( page_path.empty() )
+    {
+        return None;
+    }
+
+    return String_FromString( page_path.c_str() );
+}
+
+ref<PyObject> metrics_add_split_bytes(PyObject* pyn)
+{
+    page->split_bytes.fetch_add( Int_AsLong(pyn), std::memory_order_relaxed );
+    return None;
+}
+
+ref<PyObject> metrics_add_split_teardown(PyObject* args)
+{
+    int n = 0;
+    long long elapsed_ns = 0;
+
+    Arg_ParseTuple(args, "iL:metrics_add_split_teardown", &n, &elapsed_ns);
+
+    page->split_teardowns.fetch_add( n, std::memory_order_relaxed );
+    page->split_teardown_ns.fetch_add( elapsed_ns, std::memory_order_relaxed );
+
+    return None;
+}
+
+} // namespace pyabc
@@ -0,0 +1,24 @@
+#ifndef pyabc_metrics__H
+#define pyabc_metrics__H
+
+#include "pyabc.h"
+
+#include <cstdint>
+
+namespace pyabc
+{
+
+// publish the metrics page if PYABC_METRICS is set in the environment: "1" for
+// /dev/shm/pyabc-metrics.<pid>, or a file name, in which %p is replaced by the pid
+void metrics_init();
+
+// count an outermost command, nested ones are part of its time
+void metrics_command_done(std::int64_t elapsed_ns);
+
+ref<PyObject> metrics_path();
+ref<PyObject> metrics_add_split_bytes(PyObject* pyn);
+ref<PyObject> metrics_add_split_teardown(PyObject* args);
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_metrics__H
@@ -0,0 +1,159 @@
+#include "plugin.h"
+#include "plugin_api.h"
+#include "command.h"
+
+#include <base/cmd/cmd.h>
+#include <base/main/main.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <dlfcn.h>
+#include <stdio.h>
+
+namespace pyabc
+{
+
+namespace
+{
+
+struct loaded_plugin
+{
+    std::string path;
+    void* handle;
+};
+
+std::vector<loaded_plugin> plugins;
+
+pyabc_plugin_host host = {
+    PYABC_PLUGIN_VERSION,
+    nullptr,
+    execute_command,
+    execute_command_depth,
+};
+
+// Python loads _pyabc with RTLD_LOCAL, which hides the ABC symbols from the plugins. Loading it
+// again with RTLD_GLOBAL makes them visible. pyabc.exe exports its symbols when it is linked.
+void export_host_symbols()
+{
+    static bool done = false;
+
+    if ( done )
+    {
+        return;
+    }
+
+    done = true;
+
+    Dl_info info;
+
+    if ( dladdr( reinterpret_cast<void*>(&plugin_init), &info ) && info.dli_fname )
+    {
+        dlopen( info.dli_fname, RTLD_NOW | RTLD_NOLOAD | RTLD_GLOBAL );
+    }
+}
+
+int load_plugin(const char* path, int argc, char** argv)
+{
+    export_host_symbols();
+
+    // plugins are never unloaded, ABC keeps pointers to their commands
+    void* handle = dlopen( path, RTLD_NOW | RTLD_LOCAL | RTLD_NODELETE );
+
+    if ( !handle )
+    {
+        fprintf( stderr, "load_plugin: %s\n", dlerror() );
+        return 1;
+    }
+
+    for ( const loaded_plugin& p : plugins )
+    {
+        if ( p.handle == handle )
+        {
+            dlclose( handle );
+            return 0;
+        }
+    }
+
+    auto init = reinterpret_cast<pyabc_plugin_init_func*>( dlsym( handle, PYABC_PLUGIN_INIT ) );
+
+    if ( !init )
+    {
+        fprintf( stderr, "load_plugin: \"%s\" does not define %s()\n", path, PYABC_PLUGIN_INIT );
+        dlclose( handle );
+        return 1;
+    }
+
+    host.pAbc = Abc_FrameGetGlobalFrame();
+
+    int rc = init( &host, argc, argv );
+
+    if ( rc != 0 )
+    {
+        fprintf( stderr, "load_plugin: \"%s\" failed to initialize (%d)\n", path, rc );
+        return 1;
+    }
+
+    plugins.push_back( loaded_plugin{ path, handle } );
+
+    return 0;
+}
+
+int abc_command_load_plugin(Abc_Frame_t* pAbc, int argc, char** argv)
+{
+    if ( argc == 2 && strcmp(argv[1], "-l") == 0 )
+    {
+        for ( const loaded_plugin& p : plugins )
+        {
+            printf( "%s\n", p.path.c_str() );
+        }
+
+        return 0;
+    }
+
+    if ( argc < 2 || argv[1][0] == '-' )
+    {
+        fprintf( stderr, "usage: load_plugin [-l] <file> [args]\n" );
+        fprintf( stderr, "\t         loads a shared object that registers native commands, and passes it args\n" );
+        fprintf( stderr, "\t-l     : list the plugins loaded\n" );
+        return 1;
+    }
+
+    return load_plugin( argv[1], argc - 2, argv + 2 );
+}
+
+} // unnamed namespace
+
+void plugin_init()
+{
+    Cmd_CommandAdd( Abc_FrameGetGlobalFrame(), "Python", "load_plugin", abc_command_load_plugin, 0 );
+
+    const char* env = getenv("PYABC_PLUGINS");
+
+    if ( !env || !*env )
+    {
+        return;
+    }
+
+    std::string paths = env;
+    char* no_args[] = { nullptr };
+
+    for ( std::size_t begin = 0, end ; begin < paths.size() ; begin = end + 1 )
+    {
+        end = paths.find(':', begin);
+
+        if ( end == std::string::npos )
+        {
+            end = paths.size();
+        }
+
+        if ( end > begin )
+        {
+            load_plugin( paths.substr(begin, end - begin).c_str(), 0, no_args );
+        }
+    }
+}
+
+} // namespace pyabc
@@ -0,0 +1,14 @@
+#ifndef pyabc_plugin__H
+#define pyabc_plugin__H
+
+#include "pyabc.h"
+
+namespace pyabc
+{
+
+// register the load_plugin command, and load the plugins listed in PYABC_PLUGINS (separated by ':')
+void plugin_init();
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_plugin__H
@@ -0,0 +1,56 @@
+#ifndef pyabc_plugin_api__H
+#define pyabc_plugin_api__H
+
+// The interface between pyabc and native command plugins, shared objects loaded by the load_plugin
+// command (or listed in PYABC_PLUGINS). A plugin defines pyabc_plugin_init(), which registers its
+// commands with Cmd_CommandAdd(). ABC then dispatches them like its own commands, with no Python
+// involved. pyabc makes its ABC symbols visible to plugins, so commands use the frame and the
+// network through the ABC API directly (base/main/main.h, base/abc/abc.h).
+//
+//     #include <plugin_api.h>
+//     #include <base/main/main.h>
+//     #include <base/cmd/cmd.h>
+//
+//     static int my_command(Abc_Frame_t* pAbc, int argc, char** argv)
+//     {
+//         Abc_Ntk_t* pNtk = Abc_FrameReadNtk(pAbc);
+//         ...
+//     }
+//
+//     extern "C" int pyabc_plugin_init(const pyabc_plugin_host* host, int argc, char** argv)
+//     {
+//         Cmd_CommandAdd( host->pAbc, "My plugin", "my_command", my_command, 1 );
+//         return 0;
+//     }
+//
+// A plugin is never unloaded, and pyabc_plugin_init() is called once, when it is first loaded.
+
+#include <misc/util/abc_namespaces.h>
+
+ABC_NAMESPACE_HEADER_START
+typedef struct Abc_Frame_t_ Abc_Frame_t;
+ABC_NAMESPACE_HEADER_END
+
+// incremented when fields are added at the end of pyabc_plugin_host, plugins check version >= the one they need
+#define PYABC_PLUGIN_VERSION 1
+
+struct pyabc_plugin_host
+{
+    int version;
+
+    ABC_NAMESPACE_PREFIX Abc_Frame_t* pAbc;
+
+    // run an ABC command with the pyabc hooks (progress, metrics, journal, checkpoints), return its status
+    int (*execute_command)(const char* cmd);
+
+    // the number of execute_command() calls in progress
+    int (*execute_command_depth)();
+};
+
+// the entry point of a plugin, with the arguments that follow its file name in load_plugin. It
+// returns 0 on success, anything else makes load_plugin fail.
+extern "C" typedef int pyabc_plugin_init_func(const pyabc_plugin_host* host, int argc, char** argv);
+
+#define PYABC_PLUGIN_INIT "pyabc_plugin_init"
+
+#endif // ifndef pyabc_plugin_api__H
@@ -0,0 +1,248 @@
+#include "progress.h"
+
+#include <base/abc/abc.h>
+#include <base/main/main.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace pyabc
+{
+
+namespace
+{
+
+const std::size_t max_command_size = 256;
+
+// The record has two parts with different writers. The command part is only written by the thread that
+// runs ABC commands, one at a time, and is published with a sequence number that it makes odd for the
+// duration of an update. The frame counts are written by engine threads, possibly several at once, and
+// are independent atomics that are read without the sequence number. Relaxed ordering throughout, the
+// sequence number orders the command part.
+struct progress_record
+{
+    std::atomic<unsigned> seq{0};
+
+    std::atomic<char> command[max_command_size];
+    std::atomic<int> depth{0};         // nested run_command() calls
+    std::atomic<int> rc{0};
+    std::atomic<long> n_commands{0};
+
+    std::atomic<std::int64_t> start_ns{0};
+    std::atomic<std::int64_t> end_ns{0};
+
+    std::atomic<int> n_pis{-1};
+    std::atomic<int> n_pos{-1};
+    std::atomic<int> n_latches{-1};
+    std::atomic<int> n_ands{-1};
+
+    std::atomic<int> bmc_frame{-1};
+    std::atomic<int> solved_pos{0};
+};
+
+progress_record record;
+
+// The POs settled by the current command, one flag each. Sized when the outermost command starts, before
+// any engine thread of the command runs, so the engine threads only store to the flags.
+std::vector<std::atomic<std::uint8_t>> solved;
+
+std::int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+// the single writer of the command part makes the sequence number odd for the duration of the update
+class write_scope
+{
+public:
+
+    write_scope()
+    {
+        record.seq.store(record.seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    ~write_scope()
+    {
+        record.seq.store(record.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
+
+void store_network_size()
+{
+    Abc_Ntk_t* pNtk = Abc_FrameReadNtk( Abc_FrameGetGlobalFrame() );
+
+    record.n_pis.store( pNtk ? Abc_NtkPiNum(pNtk) : -1, std::memory_order_relaxed );
+    record.n_pos.store( pNtk ? Abc_NtkPoNum(pNtk) : -1, std::memory_order_relaxed );
+    record.n_latches.store( pNtk ? Abc_NtkLatchNum(pNtk) : -1, std::memory_order_relaxed );
+    record.n_ands.store( pNtk && Abc_NtkIsStrash(pNtk) ? Abc_NtkNodeNum(pNtk) : -1, std::memory_order_relaxed );
+}
+
+void reset_solved()
+{
+    Abc_Ntk_t* pNtk = Abc_FrameReadNtk( Abc_FrameGetGlobalFrame() );
+    std::size_t n = pNtk ? Abc_NtkPoNum(pNtk) : 0;
+
+    if ( n != solved.size() )
+    {
+        solved = std::vector<std::atomic<std::uint8_t>>(n);
+    }
+
+    for ( auto& flag : solved )
+    {
+        flag.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // unnamed namespace
+
+void progress_command_begin(const char* cmd)
+{
+    write_scope scope;
+
+    std::size_t i = 0;
+
+    for ( ; cmd[i] && i < max_command_size - 1 ; i++ )
+    {
+        record.command[i].store(cmd[i], std::memory_order_relaxed);
+    }
+
+    record.command[i].store(0, std::memory_order_relaxed);
+
+    // nested commands (run from Python commands) show up as the current command, but the timing and
+    // the frame counts belong to the outermost one
+
+    if ( record.depth.fetch_add(1, std::memory_order_relaxed) == 0 )
+    {
+        record.start_ns.store(now_ns(), std::memory_order_relaxed);
+
+        record.bmc_frame.store(-1, std::memory_order_relaxed);
+        record.solved_pos.store(0, std::memory_order_relaxed);
+
+        reset_solved();
+    }
+}
+
+void progress_command_end(int rc)
+{
+    write_scope scope;
+
+    if ( record.depth.fetch_sub(1, std::memory_order_relaxed) == 1 )
+    {
+        record.end_ns.store(now_ns(), std::memory_order_relaxed);
+    }
+
+    record.rc.store(rc, std::memory_order_relaxed);
+    record.n_commands.fetch_add(1, std::memory_order_relaxed);
+
+    store_network_size();
+}
+
+void progress_frame_done(int frame, int po, int status)
+{
+    int last = record.bmc_frame.load(std::memory_order_relaxed);
+
+    while ( frame > last && !record.bmc_frame.compare_exchange_weak(last, frame, std::memory_order_relaxed) )
+    {
+    }
+
+    // status 0 (SAT) or 1 (UNSAT) settles the PO, count each PO once per command, ignore POs that a command
+    // added to the network after it started
+    if ( po >= 0 && static_cast<std::size_t>(po) < solved.size() && ( status == 0 || status == 1 ) )
+    {
+        if ( !solved[po].exchange(1, std::memory_order_relaxed) )
+        {
+            record.solved_pos.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+ref<PyObject> progress()
+{
+    char command[max_command_size];
+
+    bool running;
+    int rc;
+    long n_commands;
+    std::int64_t start_ns;
+    std::int64_t end_ns;
+    int bmc_frame;
+    int solved_pos;
+    int n_pis;
+    int n_pos;
+    int n_latches;
+    int n_ands;
+
+    // the writer may be preempted in the middle of an update, wait for it without the GIL
+    {
+        enable_threads scope;
+
+        for (;;)
+        {
+            unsigned s0 = record.seq.load(std::memory_order_acquire);
+
+            if ( s0 & 1 )
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for ( std::size_t i = 0 ; i < max_command_size ; i++ )
+            {
+                command[i] = record.command[i].load(std::memory_order_relaxed);
+
+                if ( !command[i] )
+                {
+                    break;
+                }
+            }
+
+            command[max_command_size - 1] = 0;
+
+            running = record.depth.load(std::memory_order_relaxed) > 0;
+            rc = record.rc.load(std::memory_order_relaxed);
+            n_commands = record.n_commands.load(std::memory_order_relaxed);
+            start_ns = record.start_ns.load(std::memory_order_relaxed);
+            end_ns = record.end_ns.load(std::memory_order_relaxed);
+            n_pis = record.n_pis.load(std::memory_order_relaxed);
+            n_pos = record.n_pos.load(std::memory_order_relaxed);
+            n_latches = record.n_latches.load(std::memory_order_relaxed);
+            n_ands = record.n_ands.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if ( record.seq.load(std::memory_order_relaxed) == s0 )
+            {
+                break;
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    bmc_frame = record.bmc_frame.load(std::memory_order_relaxed);
+    solved_pos = record.solved_pos.load(std::memory_order_relaxed);
+
+    double elapsed = start_ns ? ( (running ? now_ns() : end_ns) - start_ns ) * 1e-9 : 0.0;
+
+    ref<PyObject> res = Dict_New();
+
+    Dict_SetItemString(res, "command", String_FromString(command));
+    Dict_SetItemString(res, "running", Bool_FromLong(running));
+    Dict_SetItemString(res, "rc", Int_FromLong(rc));
+    Dict_SetItemString(res, "n_commands", Int_FromLong(n_commands));
+    Dict_SetItemString(res, "elapsed", Float_FromDouble(elapsed));
+    Dict_SetItemString(res, "bmc_frame", Int_FromLong(bmc_frame));
+    Dict_SetItemString(res, "solved_pos", Int_FromLong(solved_pos));
+    Dict_SetItemString(res, "n_pis", Int_FromLong(n_pis));
+    Dict_SetItemString(res, "n_pos", Int_FromLong(n_pos));
+    Dict_SetItemString(res, "n_latches", Int_FromLong(n_latches));
+    Dict_SetItemString(res, "n_ands", Int_FromLong(n_ands));
+
+    return res;
+}
+
+} // namespace pyabc
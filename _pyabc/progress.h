@@ -0,0 +1,22 @@
+#ifndef pyabc_progress__H
+#define pyabc_progress__H
+
+#include "pyabc.h"
+
+namespace pyabc
+{
+
+// A record of what run_command() is doing. It is updated by the thread that runs ABC commands, one
+// at a time like the ABC frame itself, and published with a sequence number, so that any thread can
+// read a consistent copy without touching the ABC frame. Engine threads report frames through
+// separate counters.
+
+void progress_command_begin(const char* cmd);
+void progress_command_end(int rc);
+void progress_frame_done(int frame, int po, int status);
+
+ref<PyObject> progress();
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_progress__H
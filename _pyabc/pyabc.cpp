@@ -4,6 +4,20 @@
 #include "util.h"
 #include "cex.h"
 #include "sys.h"
+#include "snapshot.h"
+#include "zygote.h"
+#include "fingerprint.h"
+#include "decompose.h"
+#include "aig.h"
+#include "progress.h"
+#include "metrics.h"
+#include "alloc.h"
+#include "checkpoint.h"
+#include "journal.h"
+#include "events.h"
+#include "constpo.h"
+#include "archive.h"
+#include "plugin.h"
 
 #include <signal.h>
 
@@ -278,6 +292,52 @@ ref<PyObject> eq_classes()
     return classes;
 }
 
+ref<PyObject> eq_classes_set(PyObject* pyclasses)
+{
+    Abc_Frame_t* pAbc = Abc_FrameGetGlobalFrame();
+    Abc_Ntk_t* pNtk = Abc_FrameReadNtk(pAbc);
+
+    Vec_Ptr_t* vPoEquivs = nullptr;
+
+    if ( pyclasses != Py_None )
+    {
+        vPoEquivs = Vec_PtrAlloc(0);
+
+        try
+        {
+            for_iterator(pyclasses, [&](PyObject* pyclass)
+            {
+                Vec_Int_t* v = Vec_IntAlloc(0);
+                Vec_PtrPush( vPoEquivs, v );
+
+                for_iterator(pyclass, [&](PyObject* item)
+                {
+                    int po = Int_AsLong(item);
+
+                    if ( po < 0 || ( pNtk && po >= Abc_NtkPoNum(pNtk) ) )
+                    {
+                        PyErr_Format(PyExc_ValueError, "PO %d is out of range", po);
+                        throw exception();
+                    }
+
+                    Vec_IntPush( v, po );
+                });
+            });
+        }
+        catch(...)
+        {
+            Vec_VecFree( reinterpret_cast<Vec_Vec_t*>(vPoEquivs) );
+            throw;
+        }
+    }
+
+    Abc_FrameReplacePoEquivs( pAbc, &vPoEquivs );
+
+    events_changed();
+
+    return None;
+}
+
 ref<PyObject> co_supp(PyObject* pyCo)
 {
     int iCo = Int_AsLong(pyCo);
@@ -347,19 +407,61 @@ init()
         PYTHONWRAPPER_FUNC_NOARGS(cex_frame, 0, ""),
         PYTHONWRAPPER_FUNC_NOARGS(n_phases, 0, ""),
         PYTHONWRAPPER_FUNC_KEYWORDS(is_const_po, 0, ""),
+        PYTHONWRAPPER_FUNC_KEYWORDS(const_pos, 0, "classify all POs as constant 0, 1 or not (-1) by simulation and SAT, return a string of signed bytes"),
 
         PYTHONWRAPPER_FUNC_O(create_abc_array, 0, ""),
         PYTHONWRAPPER_FUNC_O(pyabc_array_read_entry, 0, ""),
 
         PYTHONWRAPPER_FUNC_NOARGS(eq_classes, 0, ""),
+        PYTHONWRAPPER_FUNC_O(eq_classes_set, 0, "replace the PO equivalence classes with a list of lists of PO indices, or clear them with None"),
         PYTHONWRAPPER_FUNC_O(co_supp, 0, ""),
         PYTHONWRAPPER_FUNC_VARARGS(_is_func_iso, 0, ""),
+        PYTHONWRAPPER_FUNC_KEYWORDS(fingerprint, 0, "return a 128-bit structural hash of the current strashed network as a hex string"),
+
+        PYTHONWRAPPER_FUNC_KEYWORDS(po_groups, 0, "group the POs of the current network by support overlap"),
+        PYTHONWRAPPER_FUNC_O(po_group_fingerprint, 0, "return the fingerprint of the network restricted to a list of POs"),
+        PYTHONWRAPPER_FUNC_O(po_group_latches, 0, "return the indices of the latches in the sequential support of a list of POs"),
+        PYTHONWRAPPER_FUNC_O(select_pos, 0, "replace the current network with a copy that keeps only a list of POs and the latches they depend on, return the indices of these latches"),
+        PYTHONWRAPPER_FUNC_VARARGS(po_group_cex, 0, "map a cex of a network made by select_pos() back to the current network: po_group_cex(cex, latches, po)"),
+
+        PYTHONWRAPPER_FUNC_NOARGS(aig_to_arrays, 0, "export the current strashed network as flat arrays of 32-bit literals"),
+        PYTHONWRAPPER_FUNC_KEYWORDS(aig_from_arrays, 0, "replace the current network with one built from flat arrays of 32-bit literals"),
+        PYTHONWRAPPER_FUNC_O(read_aiger_bytes, 0, "replace the current network with binary AIGER read from a buffer (str, mmap, array)"),
+        PYTHONWRAPPER_FUNC_KEYWORDS(write_aiger_bytes, 0, "return the current network as binary AIGER in a string"),
 
         PYTHONWRAPPER_FUNC_NOARGS(cex_get_vector, 0, ""),
         PYTHONWRAPPER_FUNC_NOARGS(cex_get, 0, ""),
         PYTHONWRAPPER_FUNC_NOARGS(status_get_vector, 0, ""),
+        PYTHONWRAPPER_FUNC_O(cex_loads, 0, "build a cex from a string returned by cex.dumps()"),
+        PYTHONWRAPPER_FUNC_O(cex_set_vector, 0, "replace the cex vector with a list of cex objects, None or True"),
+        PYTHONWRAPPER_FUNC_O(status_set_vector, 0, "replace the status vector with a list of integers"),
+        PYTHONWRAPPER_FUNC_KEYWORDS(cex_archive_open, 0, "open a memory-mapped cex archive file, created if writable, return None if it cannot be opened"),
 
         PYTHONWRAPPER_FUNC_O(run_command, 0, ""),
+        PYTHONWRAPPER_FUNC_NOARGS(progress, 0, "return a consistent copy of the progress record of run_command(), safe to call from any thread"),
+        PYTHONWRAPPER_FUNC_NOARGS(metrics_path, 0, "return the file name of the published metrics page, or None"),
+        PYTHONWRAPPER_FUNC_O(metrics_add_split_bytes, 0, "count bytes received from split workers in the metrics page"),
+        PYTHONWRAPPER_FUNC_VARARGS(metrics_add_split_teardown, 0, "count n split jobs torn down in elapsed_ns nanoseconds in the metrics page"),
+
+        PYTHONWRAPPER_FUNC_NOARGS(allocator_name, 0, "return the name of the memory allocator in use"),
+        PYTHONWRAPPER_FUNC_NOARGS(allocator_stats, 0, "return heap statistics (allocated, active, resident, mapped, fragmentation)"),
+        PYTHONWRAPPER_FUNC_NOARGS(allocator_trim, 0, "return free heap memory to the system"),
+
+        PYTHONWRAPPER_FUNC_KEYWORDS(checkpoint_enable, 0, "write checkpoints of the state and the commands run to a file at command boundaries"),
+        PYTHONWRAPPER_FUNC_NOARGS(checkpoint_disable, 0, "stop writing checkpoints"),
+        PYTHONWRAPPER_FUNC_KEYWORDS(checkpoint_run, 0, "run a script of ABC commands, with a checkpoint after each completed command, raise IOError if a checkpoint cannot be written"),
+        PYTHONWRAPPER_FUNC_KEYWORDS(checkpoint_resume, 0, "restore a checkpoint and continue its script, return None if it cannot be read, raise IOError if a checkpoint cannot be written"),
+        PYTHONWRAPPER_FUNC_NOARGS(checkpoint_history, 0, "return the commands completed since checkpointing started, including those before a resume"),
+        PYTHONWRAPPER_FUNC_NOARGS(checkpoint_failed, 0, "return True if a checkpoint after a command could not be written since checkpointing started"),
+
+        PYTHONWRAPPER_FUNC_O(journal_start, 0, "record commands, Python commands and frame-done events with their timing into a journal file"),
+        PYTHONWRAPPER_FUNC_NOARGS(journal_stop, 0, "stop recording the journal"),
+
+        PYTHONWRAPPER_FUNC_NOARGS(event_generations, 0, "return the generation numbers of the network, prob_status, cex, status vector and cex vector"),
+        PYTHONWRAPPER_FUNC_KEYWORDS(event_subscribe, 0, "subscribe to changes of the frame, with a callback called with a dict of event -> generation, or for event_poll()"),
+        PYTHONWRAPPER_FUNC_O(event_unsubscribe, 0, "remove a subscription returned by event_subscribe()"),
+        PYTHONWRAPPER_FUNC_O(event_poll, 0, "return the changes not yet seen by a subscription as a dict of event -> generation"),
+
         PYTHONWRAPPER_FUNC_O(set_command_callback, 0, ""),
         PYTHONWRAPPER_FUNC_O(set_frame_done_callback, 0, ""),
         PYTHONWRAPPER_FUNC_KEYWORDS(register_command, 0, ""),
@@ -370,6 +472,19 @@ init()
         PYTHONWRAPPER_FUNC_O(add_sigchld_fd, 0, "add a file descriptor to receive a byte every time SIGCHLD is recieved "),
         PYTHONWRAPPER_FUNC_O(remove_sigchld_fd, 0, ""),
 
+        PYTHONWRAPPER_FUNC_NOARGS(job_group_start, 0, "make the current process the leader of a new process group, killed as a whole when it is killed by SIGQUIT"),
+        PYTHONWRAPPER_FUNC_O(child_exited, 0, "return True if a child exited, without reaping it (waitid with WNOWAIT)"),
+
+        PYTHONWRAPPER_FUNC_NOARGS(get_cpu_affinity, 0, "return the list of CPUs the current process may run on"),
+        PYTHONWRAPPER_FUNC_O(set_cpu_affinity, 0, "restrict the current process to a list of CPUs"),
+
+        PYTHONWRAPPER_FUNC_NOARGS(snapshot_save, 0, "return the current network and status as a string"),
+        PYTHONWRAPPER_FUNC_O(snapshot_restore, 0, "restore the current network and status from a string returned by snapshot_save()"),
+
+        PYTHONWRAPPER_FUNC_NOARGS(zygote_enabled, 0, "return True if the fork-server is running"),
+        PYTHONWRAPPER_FUNC_KEYWORDS(zygote_fork, 0, "run an ABC script in a process forked from the fork-server, return its pid"),
+        PYTHONWRAPPER_FUNC_O(zygote_kill, 0, "ask the fork-server to send SIGQUIT to one of its workers, return False if it already exited"),
+
         { 0 }
     };
 
@@ -380,8 +495,15 @@ init()
     );
 
     cex::initialize(mod);
+    cex_archive::initialize(mod);
 
     sys_init();
+    zygote_init();
+    metrics_init();
+    checkpoint_init();
+    journal_init();
+    events_init();
+    plugin_init();
 }
 
 } // namespace pyabc
@@ -0,0 +1,473 @@
+#include "snapshot.h"
+
+#include "aig.h"
+#include "cex.h"
+#include "events.h"
+
+#include <base/abc/abc.h>
+#include <base/main/main.h>
+#include <misc/util/utilCex.h>
+
+#include <cstdint>
+#include <cstring>
+
+namespace pyabc
+{
+
+namespace
+{
+
+void put_section(std::string& buf, const std::string& section)
+{
+    std::uint32_t size = section.size();
+    buf.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    buf.append(section);
+}
+
+bool get_section(const char*& data, const char* end, const char*& section, std::size_t& size)
+{
+    std::uint32_t n;
+
+    if ( end - data < static_cast<std::ptrdiff_t>(sizeof(n)) )
+    {
+        return false;
+    }
+
+    memcpy(&n, data, sizeof(n));
+    data += sizeof(n);
+
+    if ( static_cast<std::size_t>(end - data) < n )
+    {
+        return false;
+    }
+
+    section = data;
+    size = n;
+    data += n;
+
+    return true;
+}
+
+void put_int(std::string& buf, std::int32_t x)
+{
+    buf.append(reinterpret_cast<const char*>(&x), sizeof(x));
+}
+
+bool get_int(const char*& data, const char* end, std::int32_t& x)
+{
+    if ( end - data < static_cast<std::ptrdiff_t>(sizeof(x)) )
+    {
+        return false;
+    }
+
+    memcpy(&x, data, sizeof(x));
+    data += sizeof(x);
+
+    return true;
+}
+
+// the optional vectors of the frame, an empty section means the vector was not set
+
+std::string write_statuses(Vec_Int_t* vStatuses)
+{
+    std::string buf;
+
+    if ( vStatuses )
+    {
+        put_int(buf, Vec_IntSize(vStatuses));
+
+        int status, i;
+        Vec_IntForEachEntry( vStatuses, status, i )
+        {
+            put_int(buf, status);
+        }
+    }
+
+    return buf;
+}
+
+Vec_Int_t* read_statuses(const char* data, std::size_t size)
+{
+    const char* end = data + size;
+    std::int32_t n;
+
+    if ( !get_int(data, end, n) || n < 0 || static_cast<std::size_t>(end - data) != n * sizeof(std::int32_t) )
+    {
+        return nullptr;
+    }
+
+    Vec_Int_t* vStatuses = Vec_IntAlloc(n);
+
+    for ( std::int32_t status ; get_int(data, end, status) ; )
+    {
+        Vec_IntPush(vStatuses, status);
+    }
+
+    return vStatuses;
+}
+
+// each cex is [i32 kind] followed, for a cex, by a section with its serialization
+enum { cex_none = 0, cex_sentinel = 1, cex_present = 2 };
+
+std::string write_cexes(Vec_Ptr_t* vCexes)
+{
+    std::string buf;
+
+    if ( vCexes )
+    {
+        put_int(buf, Vec_PtrSize(vCexes));
+
+        Abc_Cex_t* pCex;
+        int i;
+
+        Vec_PtrForEachEntry( Abc_Cex_t*, vCexes, pCex, i )
+        {
+            if ( !pCex )
+            {
+                put_int(buf, cex_none);
+            }
+            else if ( pCex == reinterpret_cast<Abc_Cex_t*>(1) )
+            {
+                put_int(buf, cex_sentinel);
+            }
+            else
+            {
+                put_int(buf, cex_present);
+
+                std::string cex;
+                cex_write(pCex, cex);
+                put_section(buf, cex);
+            }
+        }
+    }
+
+    return buf;
+}
+
+void free_cexes(Vec_Ptr_t* vCexes)
+{
+    Abc_Cex_t* pCex;
+    int i;
+
+    Vec_PtrForEachEntry( Abc_Cex_t*, vCexes, pCex, i )
+    {
+        if ( pCex && pCex != reinterpret_cast<Abc_Cex_t*>(1) )
+        {
+            Abc_CexFree(pCex);
+        }
+    }
+
+    Vec_PtrFree(vCexes);
+}
+
+Vec_Ptr_t* read_cexes(const char* data, std::size_t size)
+{
+    const char* end = data + size;
+    std::int32_t n;
+
+    if ( !get_int(data, end, n) || n < 0 || static_cast<std::size_t>(end - data) < n * sizeof(std::int32_t) )
+    {
+        return nullptr;
+    }
+
+    Vec_Ptr_t* vCexes = Vec_PtrAlloc(n);
+
+    for ( std::int32_t i = 0 ; i < n ; i++ )
+    {
+        std::int32_t kind;
+
+        const char* cex;
+        std::size_t cex_size;
+
+        Abc_Cex_t* pCex = nullptr;
+
+        if ( !get_int(data, end, kind) )
+        {
+            break;
+        }
+
+        if ( kind == cex_sentinel )
+        {
+            pCex = reinterpret_cast<Abc_Cex_t*>(1);
+        }
+        else if ( kind == cex_present && ( !get_section(data, end, cex, cex_size) || !(pCex = cex_read(cex, cex_size)) ) )
+        {
+            break;
+        }
+        else if ( kind != cex_none && kind != cex_present )
+        {
+            break;
+        }
+
+        Vec_PtrPush(vCexes, pCex);
+    }
+
+    if ( Vec_PtrSize(vCexes) != n || data != end )
+    {
+        free_cexes(vCexes);
+        return nullptr;
+    }
+
+    return vCexes;
+}
+
+// [i32 n] followed by n classes, each [i32 size] followed by the POs
+std::string write_equivs(Vec_Ptr_t* vEquivs)
+{
+    std::string buf;
+
+    if ( vEquivs )
+    {
+        put_int(buf, Vec_PtrSize(vEquivs));
+
+        Vec_Int_t* vClass;
+        int i;
+
+        Vec_PtrForEachEntry( Vec_Int_t*, vEquivs, vClass, i )
+        {
+            buf.append( write_statuses(vClass) );
+        }
+    }
+
+    return buf;
+}
+
+Vec_Ptr_t* read_equivs(const char* data, std::size_t size)
+{
+    const char* end = data + size;
+    std::int32_t n;
+
+    if ( !get_int(data, end, n) || n < 0 || static_cast<std::size_t>(end - data) < n * sizeof(std::int32_t) )
+    {
+        return nullptr;
+    }
+
+    Vec_Ptr_t* vEquivs = Vec_PtrAlloc(n);
+
+    for ( std::int32_t i = 0 ; i < n ; i++ )
+    {
+        std::int32_t m;
+        const char* p = data;
+
+        if ( !get_int(p, end, m) || m < 0 || static_cast<std::size_t>(end - p) < m * sizeof(std::int32_t) )
+        {
+            break;
+        }
+
+        std::size_t class_size = sizeof(std::int32_t) * (m + 1);
+
+        Vec_PtrPush( vEquivs, read_statuses(data, class_size) );
+        data += class_size;
+    }
+
+    if ( Vec_PtrSize(vEquivs) != n || data != end )
+    {
+        Vec_VecFree( reinterpret_cast<Vec_Vec_t*>(vEquivs) );
+        return nullptr;
+    }
+
+    return vEquivs;
+}
+
+} // unnamed namespace
+
+// snapshot layout: [u32 size][binary AIGER] [u32 size][i32 status][cex]
+//                  [u32 size][status vector] [u32 size][cex vector] [u32 size][PO equivalence classes]
+// an empty AIGER section means there was no current network, an empty cex means there was none.
+// The three vector sections are optional, snapshots saved before they were added are still accepted.
+
+bool save_snapshot(std::string& buf)
+{
+    Abc_Frame_t* pAbc = Abc_FrameGetGlobalFrame();
+    Abc_Ntk_t* pNtk = Abc_FrameReadNtk(pAbc);
+
+    std::string aig;
+    std::string status;
+
+    if ( pNtk )
+    {
+        if ( !aiger_write(pNtk, aig, true) )
+        {
+            return false;
+        }
+
+        std::int32_t prob_status = Abc_FrameReadProbStatus(pAbc);
+        status.append( reinterpret_cast<const char*>(&prob_status), sizeof(prob_status) );
+
+        Abc_Cex_t* pCex = static_cast<Abc_Cex_t*>(Abc_FrameReadCex(pAbc));
+
+        if ( pCex && pCex != reinterpret_cast<Abc_Cex_t*>(1) )
+        {
+            cex_write(pCex, status);
+        }
+    }
+
+    put_section(buf, aig);
+    put_section(buf, status);
+
+    if ( pNtk )
+    {
+        put_section(buf, write_statuses( Abc_FrameReadPoStatuses(pAbc) ));
+        put_section(buf, write_cexes( Abc_FrameReadCexVec(pAbc) ));
+        put_section(buf, write_equivs( Abc_FrameReadPoEquivs(pAbc) ));
+    }
+
+    return true;
+}
+
+bool restore_snapshot(const char* data, std::size_t size)
+{
+    const char* end = data + size;
+
+    const char* aig;
+    std::size_t aig_size;
+
+    const char* status;
+    std::size_t status_size;
+
+    if ( !get_section(data, end, aig, aig_size) || !get_section(data, end, status, status_size) )
+    {
+        return false;
+    }
+
+    if ( aig_size == 0 )
+    {
+        // there was no current network when the snapshot was saved
+        Abc_Frame_t* pAbc = Abc_FrameGetGlobalFrame();
+
+        Abc_FrameDeleteAllNetworks( pAbc );
+        Abc_FrameClearVerifStatus( pAbc );
+
+        events_network_replaced();
+
+        return true;
+    }
+
+    std::int32_t prob_status;
+
+    if ( status_size < sizeof(prob_status) )
+    {
+        return false;
+    }
+
+    memcpy(&prob_status, status, sizeof(prob_status));
+
+    const char* vectors[3] = { nullptr, nullptr, nullptr };
+    std::size_t vector_sizes[3] = { 0, 0, 0 };
+
+    for ( int i = 0 ; i < 3 && data != end ; i++ )
+    {
+        if ( !get_section(data, end, vectors[i], vector_sizes[i]) )
+        {
+            return false;
+        }
+    }
+
+    Abc_Cex_t* pCex = nullptr;
+    Vec_Int_t* vStatuses = nullptr;
+    Vec_Ptr_t* vCexes = nullptr;
+    Vec_Ptr_t* vEquivs = nullptr;
+    Abc_Ntk_t* pNtk = nullptr;
+
+    bool ok =
+        ( status_size == sizeof(prob_status) || (pCex = cex_read(status + sizeof(prob_status), status_size - sizeof(prob_status))) ) &&
+        ( vector_sizes[0] == 0 || (vStatuses = read_statuses(vectors[0], vector_sizes[0])) ) &&
+        ( vector_sizes[1] == 0 || (vCexes = read_cexes(vectors[1], vector_sizes[1])) ) &&
+        ( vector_sizes[2] == 0 || (vEquivs = read_equivs(vectors[2], vector_sizes[2])) ) &&
+        (pNtk = aiger_read(aig, aig_size));
+
+    if ( !ok )
+    {
+        if ( pCex )
+        {
+            Abc_CexFree(pCex);
+        }
+
+        if ( vStatuses )
+        {
+            Vec_IntFree(vStatuses);
+        }
+
+        if ( vCexes )
+        {
+            free_cexes(vCexes);
+        }
+
+        if ( vEquivs )
+        {
+            Vec_VecFree( reinterpret_cast<Vec_Vec_t*>(vEquivs) );
+        }
+
+        return false;
+    }
+
+    Abc_Frame_t* pAbc = Abc_FrameGetGlobalFrame();
+
+    Abc_FrameReplaceCurrentNetwork( pAbc, pNtk );
+    Abc_FrameClearVerifStatus( pAbc );
+
+    events_network_replaced();
+
+    Abc_FrameSetStatus( prob_status );
+
+    if ( pCex )
+    {
+        Abc_FrameReplaceCex( pAbc, &pCex );
+    }
+
+    if ( vStatuses )
+    {
+        Abc_FrameReplacePoStatuses( pAbc, &vStatuses );
+    }
+
+    if ( vCexes )
+    {
+        Abc_FrameReplaceCexVec( pAbc, &vCexes );
+    }
+
+    if ( vEquivs )
+    {
+        Abc_FrameReplacePoEquivs( pAbc, &vEquivs );
+    }
+
+    return true;
+}
+
+ref<PyObject> snapshot_save()
+{
+    std::string buf;
+    bool ok;
+
+    {
+        enable_threads scope;
+        ok = save_snapshot(buf);
+    }
+
+    if ( !ok )
+    {
+        return None;
+    }
+
+    return String_FromStringAndSize(buf.data(), buf.size());
+}
+
+ref<PyObject> snapshot_restore(PyObject* pybuf)
+{
+    char* data;
+    Py_ssize_t size;
+
+    String_AsStringAndSize(pybuf, &data, &size);
+
+    bool ok;
+
+    {
+        enable_threads scope;
+        ok = restore_snapshot(data, size);
+    }
+
+    events_changed();
+
+    return Bool_FromLong(ok);
+}
+
+} // namespace pyabc
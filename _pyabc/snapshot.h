@@ -0,0 +1,22 @@
+#ifndef pyabc_snapshot__H
+#define pyabc_snapshot__H
+
+#include "pyabc.h"
+
+#include <string>
+
+namespace pyabc
+{
+
+// serialize the current network and verification status into a byte string
+bool save_snapshot(std::string& buf);
+
+// replace the current network and verification status with a saved snapshot
+bool restore_snapshot(const char* data, std::size_t size);
+
+ref<PyObject> snapshot_save();
+ref<PyObject> snapshot_restore(PyObject* pybuf);
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_snapshot__H
@@ -9,6 +9,10 @@
 #include <pthread.h>
 #include <sys/wait.h>
 
+#ifdef __linux__
+#include <sched.h>
+#endif
+
 namespace pyabc
 {
 
@@ -29,6 +33,9 @@ void sigchld_handler(int)
 
 std::set<std::string> temporary_files;
 
+// set in a process that leads the process group of a split job
+bool job_group_leader = false;
+
 void sigquit_handler(int sig)
 {
     for (auto& fn : temporary_files)
@@ -36,6 +43,15 @@ void sigquit_handler(int sig)
         unlink(fn.c_str());
     }
 
+    // take the rest of the job down with us, including the processes started by Util_SignalSystem(). The
+    // signal reaches this process too, SIGTERM can be ignored here where SIGKILL would stop us before
+    // _exit(). The parent kills what remains of the group with SIGKILL before it reaps us.
+    if ( job_group_leader )
+    {
+        signal(SIGTERM, SIG_IGN);
+        kill(0, SIGTERM);
+    }
+
     _exit(1);
 }
 
@@ -97,6 +113,7 @@ void atfork_child_handler()
 
     sigchld_wakeup_fds.clear();
     temporary_files.clear();
+    job_group_leader = false;
 
     sigprocmask(SIG_SETMASK, &pre_fork_sigprocmask, nullptr);
 
@@ -129,6 +146,96 @@ void remove_sigchld_fd(PyObject* pyfd)
     remove_sigchld_fd(fd);
 }
 
+bool become_job_group_leader()
+{
+    if ( setpgid(0, 0) < 0 )
+    {
+        return false;
+    }
+
+    job_group_leader = true;
+    return true;
+}
+
+ref<PyObject> job_group_start()
+{
+    return Bool_FromLong( become_job_group_leader() );
+}
+
+ref<PyObject> child_exited(PyObject* pypid)
+{
+    pid_t pid = Int_AsLong(pypid);
+
+    siginfo_t info;
+    info.si_pid = 0;
+
+    // WNOWAIT leaves the child a zombie, which keeps its pid and its process group from being reused
+    if ( retry_eintr( waitid, P_PID, static_cast<id_t>(pid), &info, WEXITED | WNOHANG | WNOWAIT ) < 0 )
+    {
+        PyErr_SetFromErrno(PyExc_OSError);
+        throw exception();
+    }
+
+    return Bool_FromLong( info.si_pid == pid );
+}
+
+#ifdef __linux__
+
+ref<PyObject> get_cpu_affinity()
+{
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+
+    if ( sched_getaffinity(0, sizeof(mask), &mask) < 0 )
+    {
+        return None;
+    }
+
+    ref<PyObject> cpus = List_New(0);
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if ( CPU_ISSET(cpu, &mask) )
+        {
+            List_Append(cpus, Int_FromLong(cpu));
+        }
+    }
+
+    return cpus;
+}
+
+ref<PyObject> set_cpu_affinity(PyObject* pycpus)
+{
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+
+    for_iterator(pycpus, [&](PyObject* item)
+    {
+        int cpu = Int_AsLong(item);
+
+        if ( cpu >= 0 && cpu < CPU_SETSIZE )
+        {
+            CPU_SET(cpu, &mask);
+        }
+    });
+
+    return Bool_FromLong( sched_setaffinity(0, sizeof(mask), &mask) == 0 );
+}
+
+#else // CPU affinity is only supported on linux
+
+ref<PyObject> get_cpu_affinity()
+{
+    return None;
+}
+
+ref<PyObject> set_cpu_affinity(PyObject* pycpus)
+{
+    return False;
+}
+
+#endif // #ifdef __linux__
+
 void sys_init()
 {
     pthread_atfork(
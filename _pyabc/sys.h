@@ -12,6 +12,17 @@ void atfork_child_remove(PyObject* pyfd);
 void add_sigchld_fd(PyObject *pyfd);
 void remove_sigchld_fd(PyObject *pyfd);
 
+// move the current process into a new process group, of which it is the leader. When it is killed
+// by SIGQUIT (or SIGINT), it sends SIGTERM to the whole group before it exits.
+bool become_job_group_leader();
+ref<PyObject> job_group_start();
+
+// whether a child exited, without reaping it, so that its process group can still be killed
+ref<PyObject> child_exited(PyObject* pypid);
+
+ref<PyObject> get_cpu_affinity();
+ref<PyObject> set_cpu_affinity(PyObject* pycpus);
+
 void sys_init();
 
 } // namespace pyabc
@@ -1,7 +1,32 @@
 #include "util.h"
 
+#include <cstdio>
+
 #include <unistd.h>
 
+namespace pyabc
+{
+
+std::uint64_t rss_bytes()
+{
+    FILE* f = fopen("/proc/self/statm", "r");
+
+    if ( !f )
+    {
+        return 0;
+    }
+
+    unsigned long size = 0;
+    unsigned long resident = 0;
+
+    int n = fscanf(f, "%lu %lu", &size, &resident);
+    fclose(f);
+
+    return n == 2 ? std::uint64_t(resident) * sysconf(_SC_PAGESIZE) : 0;
+}
+
+} // namespace pyabc
+
 #ifdef __linux__
 
 #include <sys/prctl.h>
@@ -1,6 +1,7 @@
 #ifndef pyabc_util__H
 #define pyabc_util__H
 
+#include <cstdint>
 #include <initializer_list>
 
 #include <signal.h>
@@ -91,6 +92,9 @@ private:
 
 void kill_on_parent_death(int sig);
 
+// the resident set size of this process, from /proc/self/statm, or 0 where it is not available
+std::uint64_t rss_bytes();
+
 inline void install_signal_handler(std::initializer_list<int> signals, void (*handler)(int))
 {
     struct sigaction sa;
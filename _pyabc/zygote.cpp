@@ -0,0 +1,473 @@
+#include "zygote.h"
+#include "snapshot.h"
+#include "sys.h"
+#include "util.h"
+
+#include <base/main/main.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+namespace pyabc
+{
+
+// The zygote is a small process forked right after ABC is initialized, before any of the Python
+// modules are loaded and before the current network grows. Requests are sent to it over a UNIX socket:
+//
+//   fork:  [u32 fork][u32 script size][u32 snapshot size][i32 0] + SCM_RIGHTS(result fd), script, snapshot
+//          reply: [i32 pid of the worker, or -1]
+//   kill:  [u32 kill][u32 0][u32 0][i32 pid]
+//          reply: [i32 1 if the worker was signalled, 0 if it already exited]
+//
+// The worker restores the snapshot, executes the script and writes [i32 rc][snapshot] to the result
+// fd before exiting. The parent learns about termination by reading EOF from the result fd. Workers
+// are children of the zygote, not of the parent, so only the zygote may signal them: it reaps them
+// itself, as soon as they exit, and knows which pids still belong to its workers.
+
+namespace
+{
+
+enum : std::uint32_t { request_fork = 0, request_kill = 1 };
+
+struct job_header
+{
+    std::uint32_t kind;
+    std::uint32_t script_size;
+    std::uint32_t snapshot_size;
+    std::int32_t pid;
+};
+
+int zygote_fd = -1;
+std::mutex zygote_mutex;
+
+bool read_all(int fd, void* buf, std::size_t size)
+{
+    char* p = static_cast<char*>(buf);
+
+    while ( size > 0 )
+    {
+        ssize_t rc = retry_eintr(read, fd, p, size);
+
+        if ( rc <= 0 )
+        {
+            return false;
+        }
+
+        p += rc;
+        size -= rc;
+    }
+
+    return true;
+}
+
+bool write_all(int fd, const void* buf, std::size_t size)
+{
+    const char* p = static_cast<const char*>(buf);
+
+    while ( size > 0 )
+    {
+        ssize_t rc = retry_eintr(write, fd, p, size);
+
+        if ( rc <= 0 )
+        {
+            return false;
+        }
+
+        p += rc;
+        size -= rc;
+    }
+
+    return true;
+}
+
+bool send_header(int sock, const job_header& h, int fd)
+{
+    struct iovec iov;
+    iov.iov_base = const_cast<job_header*>(&h);
+    iov.iov_len = sizeof(h);
+
+    union
+    {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    // kill requests carry no fd
+    if ( fd >= 0 )
+    {
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+
+    return retry_eintr(sendmsg, sock, &msg, 0) == static_cast<int>(sizeof(h));
+}
+
+bool recv_header(int sock, job_header& h, int& fd)
+{
+    struct iovec iov;
+    iov.iov_base = &h;
+    iov.iov_len = sizeof(h);
+
+    union
+    {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    int rc = retry_eintr(recvmsg, sock, &msg, 0);
+
+    if ( rc <= 0 )
+    {
+        return false;
+    }
+
+    fd = -1;
+
+    for ( struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg) ; cmsg ; cmsg = CMSG_NXTHDR(&msg, cmsg) )
+    {
+        if ( cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS )
+        {
+            memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+
+    // the rest of a partially received header carries no ancillary data
+    if ( !read_all(sock, reinterpret_cast<char*>(&h) + rc, sizeof(h) - rc) )
+    {
+        return false;
+    }
+
+    return h.kind == request_kill || fd >= 0;
+}
+
+void run_worker(int fd, const std::string& script, const std::string& snapshot)
+{
+    // a worker and the processes it starts form one process group, killed as a whole
+    become_job_group_leader();
+
+    std::int32_t rc = -1;
+
+    if ( snapshot.empty() || restore_snapshot(snapshot.data(), snapshot.size()) )
+    {
+        rc = Cmd_CommandExecute(Abc_FrameGetGlobalFrame(), script.c_str());
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+
+    std::string result;
+
+    if ( save_snapshot(result) )
+    {
+        write_all(fd, &rc, sizeof(rc)) && write_all(fd, result.data(), result.size());
+    }
+
+    _exit(0);
+}
+
+// the SIGCHLD handler of the zygote writes to this pipe, to wake up its loop and reap the workers
+int sigchld_pipe[2] = { -1, -1 };
+
+void zygote_sigchld_handler(int)
+{
+    save_restore_errno errno_scope;
+    retry_eintr(write, sigchld_pipe[1], "C", 1);
+}
+
+bool watch_workers()
+{
+    if ( pipe(sigchld_pipe) < 0 )
+    {
+        return false;
+    }
+
+    for ( int fd : sigchld_pipe )
+    {
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    install_signal_handler({SIGCHLD}, zygote_sigchld_handler);
+
+    return true;
+}
+
+void unwatch_workers()
+{
+    uninstall_signal_handler({SIGCHLD});
+
+    close(sigchld_pipe[0]);
+    close(sigchld_pipe[1]);
+}
+
+// a worker that is not reaped yet keeps its pid, so the pids in the set can be signalled safely
+void reap_workers(std::set<pid_t>& workers)
+{
+    pid_t pid;
+
+    while ( ( pid = waitpid(-1, nullptr, WNOHANG) ) > 0 )
+    {
+        workers.erase(pid);
+    }
+}
+
+void zygote_loop(int sock)
+{
+    std::set<pid_t> workers;
+
+    if ( !watch_workers() )
+    {
+        _exit(0);
+    }
+
+    for (;;)
+    {
+        struct pollfd fds[2] = { { sock, POLLIN, 0 }, { sigchld_pipe[0], POLLIN, 0 } };
+
+        if ( retry_eintr(poll, fds, 2, -1) < 0 )
+        {
+            _exit(0);
+        }
+
+        // reap the workers that exited while the zygote was idle, without waiting for the next request
+        if ( fds[1].revents & POLLIN )
+        {
+            char buf[64];
+
+            while ( read(sigchld_pipe[0], buf, sizeof(buf)) > 0 )
+            {
+            }
+        }
+
+        reap_workers(workers);
+
+        if ( !( fds[0].revents & ( POLLIN | POLLHUP | POLLERR ) ) )
+        {
+            continue;
+        }
+
+        job_header h;
+        int fd;
+
+        if ( !recv_header(sock, h, fd) )
+        {
+            _exit(0);
+        }
+
+        if ( h.kind == request_kill )
+        {
+            std::int32_t killed = workers.count(h.pid) && kill(h.pid, SIGQUIT) == 0;
+
+            if ( !write_all(sock, &killed, sizeof(killed)) )
+            {
+                _exit(0);
+            }
+
+            continue;
+        }
+
+        std::string script(h.script_size, '\0');
+        std::string snapshot(h.snapshot_size, '\0');
+
+        if ( !read_all(sock, &script[0], script.size()) || !read_all(sock, &snapshot[0], snapshot.size()) )
+        {
+            _exit(0);
+        }
+
+        std::int32_t pid = fork();
+
+        if ( pid == 0 )
+        {
+            close(sock);
+            unwatch_workers();
+            run_worker(fd, script, snapshot);
+        }
+
+        close(fd);
+
+        if ( pid > 0 )
+        {
+            workers.insert(pid);
+        }
+
+        if ( !write_all(sock, &pid, sizeof(pid)) )
+        {
+            _exit(0);
+        }
+    }
+}
+
+void atfork_child_handler()
+{
+    // children of the main process do not share its fork-server
+
+    if ( zygote_fd >= 0 )
+    {
+        close(zygote_fd);
+        zygote_fd = -1;
+    }
+}
+
+} // unnamed namespace
+
+void zygote_init()
+{
+    const char* env = getenv("PYABC_ZYGOTE");
+
+    if ( !env || !*env || strcmp(env, "0") == 0 )
+    {
+        return;
+    }
+
+    int sv[2];
+
+    if ( socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0 )
+    {
+        return;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t pid = fork();
+
+    if ( pid == 0 )
+    {
+        close(sv[0]);
+        zygote_loop(sv[1]);
+    }
+
+    close(sv[1]);
+
+    if ( pid < 0 )
+    {
+        close(sv[0]);
+        return;
+    }
+
+    zygote_fd = sv[0];
+    pthread_atfork(nullptr, nullptr, atfork_child_handler);
+}
+
+ref<PyObject> zygote_enabled()
+{
+    return Bool_FromLong( zygote_fd >= 0 );
+}
+
+ref<PyObject> zygote_fork(PyObject* args, PyObject* kwds)
+{
+    static char *kwlist[] = { "script", "fd", "snapshot", NULL };
+
+    char* script = nullptr;
+    int fd = -1;
+    int fSnapshot = 1;
+
+    Arg_ParseTupleAndKeywords(args, kwds, "si|i:zygote_fork", kwlist, &script, &fd, &fSnapshot);
+
+    std::int32_t pid = -1;
+
+    {
+        enable_threads scope;
+
+        std::string snapshot;
+
+        if ( fSnapshot )
+        {
+            if ( !save_snapshot(snapshot) )
+            {
+                snapshot.clear();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(zygote_mutex);
+
+        if ( zygote_fd >= 0 )
+        {
+            job_header h;
+            h.kind = request_fork;
+            h.script_size = strlen(script);
+            h.snapshot_size = snapshot.size();
+            h.pid = 0;
+
+            bool ok =
+                send_header(zygote_fd, h, fd) &&
+                write_all(zygote_fd, script, h.script_size) &&
+                write_all(zygote_fd, snapshot.data(), snapshot.size()) &&
+                read_all(zygote_fd, &pid, sizeof(pid));
+
+            if ( !ok )
+            {
+                pid = -1;
+            }
+        }
+    }
+
+    return Int_FromLong(pid);
+}
+
+ref<PyObject> zygote_kill(PyObject* pypid)
+{
+    std::int32_t pid = Int_AsLong(pypid);
+    std::int32_t killed = 0;
+
+    {
+        enable_threads scope;
+
+        std::lock_guard<std::mutex> lock(zygote_mutex);
+
+        if ( zygote_fd >= 0 )
+        {
+            job_header h;
+            h.kind = request_kill;
+            h.script_size = 0;
+            h.snapshot_size = 0;
+            h.pid = pid;
+
+            bool ok =
+                send_header(zygote_fd, h, -1) &&
+                read_all(zygote_fd, &killed, sizeof(killed));
+
+            if ( !ok )
+            {
+                killed = 0;
+            }
+        }
+    }
+
+    return Bool_FromLong(killed);
+}
+
+} // namespace pyabc
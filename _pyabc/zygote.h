@@ -0,0 +1,18 @@
+#ifndef pyabc_zygote__H
+#define pyabc_zygote__H
+
+#include "pyabc.h"
+
+namespace pyabc
+{
+
+// fork the fork-server if PYABC_ZYGOTE is set in the environment
+void zygote_init();
+
+ref<PyObject> zygote_enabled();
+ref<PyObject> zygote_fork(PyObject* args, PyObject* kwds);
+ref<PyObject> zygote_kill(PyObject* pypid);
+
+} // namespace pyabc
+
+#endif // ifndef pyabc_zygote__H
@@ -1,7 +1,34 @@
 from _pyabc import *
 
+import sys
+import types
+
 from commands import add_abc_command
-import split
+
+
+class _lazy_module(types.ModuleType):
+    """
+    A placeholder for a submodule of pyabc that is imported on first attribute access.
+    Importing the submodule replaces the placeholder in the package.
+    """
+
+    def __getattr__(self, attr):
+        __import__(self.__name__)
+        return getattr(sys.modules[self.__name__], attr)
+
+
+# split and remote pull in pickle, cStringIO, socket, threading and more, which most short-lived
+# pyabc.exe invocations never use
+
+split = _lazy_module(__name__ + '.split')
+remote = _lazy_module(__name__ + '.remote')
+
+
+def _cmd_pyabc_worker(args):
+    return remote.cmd_pyabc_worker(args)
+
+add_abc_command(_cmd_pyabc_worker, "Python", "pyabc_worker", 0)
+
 
 import redirect
 from getch import getch
@@ -9,5 +36,8 @@ from getch import getch
 def cex_put(cex):
     cex.put()
 
+import copy_reg
+copy_reg.pickle(cex, lambda c: (cex_loads, (c.dumps(),)))
+
 SAT = 0
 UNSAT = 1
@@ -0,0 +1,267 @@
+"""
+module pyabc.cache
+
+A persistent cache of ABC command results.
+
+Before a command is executed, the cache looks up the pair (current state, command text) in an
+on-disk store. The state is the whole snapshot of the frame: the network with its PI, PO and latch
+names, prob_status, the current cex, the status and cex vectors and the PO equivalence classes. On a
+hit, the state saved after the original run is restored instead of executing the command. Only
+commands that are deterministic functions of that state should be cached.
+
+Usage:
+
+    c = result_cache('/var/cache/pyabc', max_bytes=1<<30)
+    rc = c.run_command('&get; &dc2; &put; pdr')
+    print c.stats()
+
+Only strashed networks are cached. Entries are stored in a fixed binary layout, never unpickled, so
+a cache directory may be shared: [magic][i32 rc][u32 command size][command][snapshot]. The directory
+is only listed for eviction, when the bytes stored since the last listing may have exceeded the
+limits.
+
+The default cache used by cached_run_command() is stored in $PYABC_CACHE_DIR, if set.
+"""
+
+import os
+import errno
+import struct
+import hashlib
+import tempfile
+
+import _pyabc
+
+
+_MAGIC = 'PYABCRC1'
+_entry_header = struct.Struct('!8siI')
+
+
+class result_cache(object):
+
+    def __init__(self, path, max_bytes=1<<30, max_entries=None):
+
+        self.path = path
+        self.max_bytes = max_bytes
+        self.max_entries = max_entries
+
+        self.hits = 0
+        self.misses = 0
+        self.stores = 0
+        self.evictions = 0
+
+        # the size of the cache at the last listing, plus what was stored since, None until listed
+        self.bytes = None
+        self.count = None
+
+        try:
+            os.makedirs(path)
+        except OSError as e:
+            if e.errno != errno.EEXIST:
+                raise
+
+    def key(self, cmd):
+        """ the cache key of executing cmd on the current state, or None if there is no strashed network """
+
+        if _pyabc.fingerprint(incremental=True) is None:
+            return None
+
+        snapshot = _pyabc.snapshot_save()
+
+        if snapshot is None:
+            return None
+
+        h = hashlib.sha1(cmd)
+        h.update('\0')
+        h.update(snapshot)
+
+        return h.hexdigest()
+
+    def _entry(self, key):
+
+        return os.path.join(self.path, key + '.entry')
+
+    def lookup(self, key, cmd):
+        """ restore the result stored for key and return the return code, or None on a miss """
+
+        fname = self._entry(key)
+
+        try:
+            with open(fname, 'rb') as f:
+                data = f.read()
+        except IOError:
+            return None
+
+        if len(data) < _entry_header.size:
+            return None
+
+        magic, rc, n = _entry_header.unpack_from(data)
+        start = _entry_header.size
+
+        if magic != _MAGIC or data[start:start+n] != cmd:
+            return None
+
+        if not _pyabc.snapshot_restore( data[start+n:] ):
+            return None
+
+        # the modification time orders entries for LRU eviction
+        try:
+            os.utime(fname, None)
+        except OSError:
+            pass
+
+        return rc
+
+    def store(self, key, cmd, rc):
+        """ store the current network and status as the result of executing cmd """
+
+        snapshot = _pyabc.snapshot_save()
+
+        if snapshot is None:
+            return
+
+        fd, tmp = tempfile.mkstemp(dir=self.path, suffix='.tmp')
+
+        try:
+            with os.fdopen(fd, 'wb') as f:
+                f.write( _entry_header.pack(_MAGIC, rc, len(cmd)) )
+                f.write( cmd )
+                f.write( snapshot )
+            os.rename(tmp, self._entry(key))
+        except:
+            os.unlink(tmp)
+            raise
+
+        self.stores += 1
+
+        if self.bytes is None:
+            self.evict()
+            return
+
+        self.bytes += _entry_header.size + len(cmd) + len(snapshot)
+        self.count += 1
+
+        if self._over_limits(self.bytes, self.count):
+            self.evict()
+
+    def run_command(self, cmd):
+
+        key = self.key(cmd)
+
+        if key is not None:
+
+            rc = self.lookup(key, cmd)
+
+            if rc is not None:
+                self.hits += 1
+                return rc
+
+        self.misses += 1
+
+        rc = _pyabc.run_command(cmd)
+
+        if key is not None and rc == 0:
+            self.store(key, cmd, rc)
+
+        return rc
+
+    def _entries(self):
+
+        entries = []
+
+        for name in os.listdir(self.path):
+
+            if not name.endswith('.entry'):
+                continue
+
+            fname = os.path.join(self.path, name)
+
+            try:
+                st = os.stat(fname)
+            except OSError:
+                continue
+
+            entries.append( (st.st_mtime, st.st_size, fname) )
+
+        return entries
+
+    def _over_limits(self, total, count):
+
+        too_big = self.max_bytes is not None and total > self.max_bytes
+        too_many = self.max_entries is not None and count > self.max_entries
+
+        return too_big or too_many
+
+    def evict(self):
+        """ remove the least recently used entries until the cache is within its limits """
+
+        entries = self._entries()
+        entries.sort()
+
+        total = sum( size for _, size, _ in entries )
+
+        while entries and self._over_limits(total, len(entries)):
+
+            _, size, fname = entries.pop(0)
+
+            try:
+                os.unlink(fname)
+            except OSError:
+                pass
+
+            total -= size
+            self.evictions += 1
+
+        self.bytes = total
+        self.count = len(entries)
+
+    def clear(self):
+
+        for _, _, fname in self._entries():
+            try:
+                os.unlink(fname)
+            except OSError:
+                pass
+
+        self.bytes = None
+        self.count = None
+
+    def stats(self):
+
+        entries = self._entries()
+
+        return {
+            'hits': self.hits,
+            'misses': self.misses,
+            'stores': self.stores,
+            'evictions': self.evictions,
+            'entries': len(entries),
+            'bytes': sum( size for _, size, _ in entries ),
+        }
+
+
+_default_cache = None
+
+
+def default_cache():
+
+    global _default_cache
+
+    if _default_cache is None:
+
+        path = os.getenv('PYABC_CACHE_DIR')
+
+        if path:
+            _default_cache = result_cache(path)
+
+    return _default_cache
+
+
+def cached_run_command(cmd):
+    """ execute cmd through the default cache, or directly if $PYABC_CACHE_DIR is not set """
+
+    c = default_cache()
+
+    if c is None:
+        return _pyabc.run_command(cmd)
+
+    return c.run_command(cmd)
@@ -0,0 +1,138 @@
+"""
+module pyabc.decompose
+
+Solve the POs of a multi-output network in parallel, one group of POs per process.
+
+Function: solve_po_groups(script, overlap=0.5, max_size=0, timeout=None, limits=None)
+
+1. The POs of the current (strashed) network are grouped by support overlap (_pyabc.po_groups()).
+2. Groups whose restricted networks are structurally identical (same _pyabc.po_group_fingerprint())
+   are solved only once.
+3. Each remaining group is extracted into its own network (_pyabc.select_pos()) in a child process,
+   which runs the ABC script on it. The network keeps all PIs, but only the latches in the
+   sequential support of the group.
+4. The per-PO statuses and cexes of all groups are merged back into the status vector and the cex
+   vector of the current network, and returned as a pair of lists. The cexes are mapped back to the
+   current network by _pyabc.po_group_cex(), which gives the other latches their initial values.
+
+The script must report cexes for the network it was given: a script that removes PIs or latches
+(e.g. 'scl') leaves cexes that cannot be mapped back, and the POs they fail stay undecided.
+
+Usage:
+
+    statuses, cexes = solve_po_groups('pdr', timeout=600)
+"""
+
+import _pyabc
+
+import split
+
+
+UNDECIDED = -1
+SAT = 0
+UNSAT = 1
+
+
+def _group_result(n):
+
+    # per-PO statuses and cexes of the current network, which has n POs
+
+    statuses = _pyabc.status_get_vector()
+    cexes = _pyabc.cex_get_vector()
+
+    if statuses is not None and len(statuses) == n:
+        if cexes is None or len(cexes) != n:
+            cexes = [None]*n
+        return statuses, [ c if isinstance(c, _pyabc.cex) else None for c in cexes ]
+
+    statuses = [UNDECIDED]*n
+    cexes = [None]*n
+
+    status = _pyabc.prob_status()
+
+    if status == UNSAT:
+        statuses = [UNSAT]*n
+
+    elif status == SAT:
+        cex = _pyabc.cex_get()
+        if isinstance(cex, _pyabc.cex) and 0 <= cex.po() < n:
+            statuses[cex.po()] = SAT
+            cexes[cex.po()] = cex
+        elif n == 1:
+            statuses[0] = SAT
+
+    return statuses, cexes
+
+
+def _solve_group(script, i, group):
+
+    latches = _pyabc.select_pos(group)
+
+    if latches is None:
+        return None
+
+    _pyabc.run_command(script)
+
+    return (i, latches) + _group_result(len(group))
+
+
+def solve_po_groups(script, overlap=0.5, max_size=0, timeout=None, limits=None):
+
+    n = _pyabc.n_pos()
+
+    groups = _pyabc.po_groups(overlap=overlap, max_size=max_size)
+
+    if groups is None:
+        return None
+
+    groups = [ sorted(g) for g in groups ]
+
+    # representative group -> groups with identical restricted networks
+    duplicates = {}
+    representatives = []
+    fingerprint_to_group = {}
+
+    for i, g in enumerate(groups):
+
+        fp = _pyabc.po_group_fingerprint(g)
+
+        if fp is not None and fp in fingerprint_to_group:
+            duplicates[ fingerprint_to_group[fp] ].append(i)
+            continue
+
+        if fp is not None:
+            fingerprint_to_group[fp] = i
+
+        duplicates[i] = [i]
+        representatives.append(i)
+
+    statuses = [UNDECIDED]*n
+    cexes = [None]*n
+
+    funcs = [ split.defer(_solve_group)(script, i, groups[i]) for i in representatives ]
+
+    for _, res in split.split_all_full(funcs, timeout=timeout, limits=limits):
+
+        if res is None:
+            continue
+
+        rep, latches, group_statuses, group_cexes = res
+
+        # the duplicates of a group have identical networks, but not necessarily the same latches
+        for gi in duplicates[rep]:
+
+            group_latches = latches if gi == rep else _pyabc.po_group_latches(groups[gi])
+
+            for j, po in enumerate(groups[gi]):
+
+                statuses[po] = group_statuses[j]
+
+                if group_cexes[j] is not None:
+                    cexes[po] = _pyabc.po_group_cex(group_cexes[j], group_latches, po)
+                    if cexes[po] is None:
+                        statuses[po] = UNDECIDED
+
+    _pyabc.status_set_vector(statuses)
+    _pyabc.cex_set_vector(cexes)
+
+    return statuses, cexes
@@ -0,0 +1,119 @@
+"""
+module pyabc.metrics
+
+Read the metrics page published by a pyabc process started with PYABC_METRICS set in its
+environment ("1" for /dev/shm/pyabc-metrics.<pid>, or a file name in which %p is replaced by
+the pid).
+
+The page is mapped once, and each sample is a single memory read with no system calls, so it
+can be sampled at high frequency. Each counter is read atomically, but a sample is not a
+consistent snapshot of all counters. commands and abc_ns count outermost commands only, and
+rss_bytes is sampled at most once a second, after a command.
+
+Usage:
+
+    m = metrics_reader.for_pid(pid)
+    sample = m.read()       # a dict, or None if the page is not initialized yet
+    m.close()
+
+From the command line:
+
+    python -m pyabc.metrics <pid or file name> [interval]
+"""
+
+import os
+import mmap
+import struct
+
+MAGIC = 0x4d434241
+VERSION = 2
+
+_header = struct.Struct('=IIiI')
+
+_fields = (
+    'commands',
+    'abc_ns',
+    'forks',
+    'split_bytes',
+    'n_pis',
+    'n_pos',
+    'n_latches',
+    'n_ands',
+    'rss_bytes',
+    'updated_ns',
+    'split_teardowns',
+    'split_teardown_ns',
+)
+
+_counters = struct.Struct('=QQQQqqqqQQQQ')
+
+PAGE_SIZE = _header.size + _counters.size
+
+
+def default_path(pid):
+    return '/dev/shm/pyabc-metrics.%d'%pid
+
+
+class metrics_reader(object):
+
+    def __init__(self, path):
+
+        fd = os.open(path, os.O_RDONLY)
+
+        try:
+            self.page = mmap.mmap(fd, PAGE_SIZE, mmap.MAP_SHARED, mmap.PROT_READ)
+        finally:
+            os.close(fd)
+
+    @staticmethod
+    def for_pid(pid):
+        return metrics_reader(default_path(pid))
+
+    def read(self):
+
+        magic, version, pid, _ = _header.unpack_from(self.page, 0)
+
+        if magic != MAGIC or version != VERSION:
+            return None
+
+        res = dict( zip(_fields, _counters.unpack_from(self.page, _header.size)) )
+        res['pid'] = pid
+
+        return res
+
+    def close(self):
+        self.page.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+
+def main(args):
+
+    import time
+
+    if not args:
+        print 'usage: python -m pyabc.metrics <pid or file name> [interval]'
+        return 1
+
+    path = default_path(int(args[0])) if args[0].isdigit() else args[0]
+    interval = float(args[1]) if len(args) > 1 else 1.0
+
+    with metrics_reader(path) as m:
+
+        while True:
+
+            sample = m.read()
+
+            if sample is not None:
+                print ' '.join( '%s=%d'%(f, sample[f]) for f in ('pid',) + _fields )
+
+            time.sleep(interval)
+
+
+if __name__ == "__main__":
+    import sys
+    sys.exit(main(sys.argv[1:]))
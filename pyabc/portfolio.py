@@ -0,0 +1,259 @@
+"""
+module pyabc.portfolio
+
+Run a portfolio of ABC engines on the current network, learning from past runs which engines
+settle which kinds of designs, and how fast.
+
+Designs are described by cheap features (n_ands, n_latches, n_pos, n_levels), rounded into
+logarithmic buckets. For each bucket and engine, a history store keeps the number of runs, the
+number of runs that settled the property (SAT or UNSAT), their total time, and the number of
+runs stopped by their time budget.
+
+Function: run_portfolio(engines, timeout=None, slots=None, store=None)
+
+1. The engines, a list of (name, script) pairs, are ordered by their expected time to settle a
+   design of this bucket (mean settling time divided by the estimated probability of settling).
+   Engines with no history are tried after the engines that are known to do well.
+2. The first `slots` engines are started, each in its own process on a copy of the current
+   network. When an engine finishes without settling the property, the next one is started.
+3. An engine with a history gets a time budget of a few times its slowest past settling run,
+   and is stopped if it exceeds it, to free its slot for the next engine.
+4. As soon as one engine settles the property, the others are killed, its network and status are
+   restored in this process, and (name, status) is returned. Otherwise (None, -1) is returned.
+
+Every run updates the store, so the ordering improves over time.
+
+Usage:
+
+    engines = [ ('pdr', 'pdr'), ('bmc3', 'bmc3'), ('int', 'int'), ('kind', 'dprove') ]
+    name, status = run_portfolio(engines, timeout=3600)
+
+The default store is the JSON file $PYABC_PORTFOLIO_DB, or ~/.pyabc_portfolio.json.
+"""
+
+import os
+import math
+import time
+import json
+import errno
+import fcntl
+import tempfile
+
+import _pyabc
+
+import split
+
+
+UNDECIDED = -1
+SAT = 0
+UNSAT = 1
+
+
+def design_features():
+    return dict(
+        n_ands=_pyabc.n_ands(),
+        n_latches=_pyabc.n_latches(),
+        n_pos=_pyabc.n_pos(),
+        n_levels=_pyabc.n_levels(),
+    )
+
+
+def feature_key(features):
+
+    # designs whose features are within a factor of two of each other share a bucket
+
+    def bucket(x):
+        return int(math.log(x, 2)) + 1 if x > 0 else 0
+
+    return '-'.join( '%s%d'%(k, bucket(features[k])) for k in sorted(features) )
+
+
+class history_store(object):
+
+    def __init__(self, path):
+
+        self.path = path
+
+    def _load(self):
+
+        try:
+            with open(self.path, 'r') as f:
+                return json.load(f)
+        except IOError as e:
+            if e.errno != errno.ENOENT:
+                raise
+        except ValueError:
+            pass
+
+        return {}
+
+    def stats(self, key):
+        """ return a dict of engine name -> statistics for a feature bucket """
+
+        return self._load().get(key, {})
+
+    def update(self, key, updates):
+        """ add a list of (name, settled, elapsed, timed_out) outcomes to the bucket """
+
+        # concurrent portfolios may share the store, merge under an exclusive lock
+
+        with open(self.path + '.lock', 'a') as lock:
+
+            fcntl.flock(lock, fcntl.LOCK_EX)
+
+            db = self._load()
+            bucket = db.setdefault(key, {})
+
+            for name, settled, elapsed, timed_out in updates:
+
+                s = bucket.setdefault(name, dict(runs=0, settled=0, time=0.0, max_time=0.0, timeouts=0))
+
+                s['runs'] += 1
+
+                if settled:
+                    s['settled'] += 1
+                    s['time'] += elapsed
+                    s['max_time'] = max(s['max_time'], elapsed)
+
+                if timed_out:
+                    s['timeouts'] += 1
+
+            dirname = os.path.dirname(os.path.abspath(self.path))
+            fd, tmp = tempfile.mkstemp(dir=dirname, suffix='.tmp')
+
+            with os.fdopen(fd, 'w') as f:
+                json.dump(db, f, indent=1, sort_keys=True)
+
+            os.rename(tmp, self.path)
+
+
+def default_store():
+
+    path = os.environ.get('PYABC_PORTFOLIO_DB', os.path.expanduser('~/.pyabc_portfolio.json'))
+    return history_store(path)
+
+
+def order_engines(engines, stats):
+    """ sort (name, script) pairs by expected time to settle, engines without history last """
+
+    def expected_time(name):
+
+        s = stats.get(name)
+
+        if not s or not s['settled']:
+            # no successful run yet: keep the given order, after the engines that are known to work
+            return float('inf')
+
+        p = ( s['settled'] + 1.0 ) / ( s['runs'] + 2.0 )
+        return ( s['time'] / s['settled'] ) / p
+
+    order = dict( (name, i) for i, (name, _) in enumerate(engines) )
+
+    return sorted( engines, key=lambda e: (expected_time(e[0]), order[e[0]]) )
+
+
+def engine_budget(stats, name, min_budget, budget_factor):
+    """ the time budget of an engine, or None for no budget """
+
+    s = stats.get(name)
+
+    if not s or not s['settled']:
+        return None
+
+    return max(min_budget, budget_factor * s['max_time'])
+
+
+def _run_engine(script):
+
+    _pyabc.run_command(script)
+
+    status = _pyabc.prob_status()
+
+    if status in (SAT, UNSAT):
+        return status, _pyabc.snapshot_save()
+
+    return status, None
+
+
+def run_portfolio(engines, timeout=None, slots=None, store=None, min_budget=5.0, budget_factor=4.0):
+
+    if store is None:
+        store = default_store()
+
+    if slots is None:
+        slots = len(_pyabc.get_cpu_affinity()) or 1
+
+    key = feature_key(design_features())
+    stats = store.stats(key)
+
+    pending = order_engines(engines, stats)
+
+    updates = []
+    result = (None, UNDECIDED)
+
+    with split.make_splitter() as s:
+
+        global_timer = s.add_timer(timeout) if timeout else None
+
+        running = {}        # engine uid -> (name, start time)
+        budget_timers = {}  # timer uid -> engine uid
+        timed_out = set()
+
+        def start_next():
+
+            name, script = pending.pop(0)
+
+            uid = s.fork_one(_run_engine, script)
+            running[uid] = (name, time.time())
+
+            budget = engine_budget(stats, name, min_budget, budget_factor)
+
+            if budget is not None and ( timeout is None or budget < timeout ):
+                budget_timers[ s.add_timer(budget) ] = uid
+
+        while pending and len(running) < slots:
+            start_next()
+
+        for uid, res in s:
+
+            if uid == global_timer:
+                break
+
+            if uid in budget_timers:
+
+                engine_uid = budget_timers.pop(uid)
+
+                if engine_uid in running:
+                    timed_out.add(engine_uid)
+                    s.kill(engine_uid)
+
+                continue
+
+            if uid not in running:
+                continue
+
+            name, start = running.pop(uid)
+            elapsed = time.time() - start
+
+            status, snapshot = res if res is not None else (UNDECIDED, None)
+
+            if status in (SAT, UNSAT) and snapshot is not None:
+                updates.append( (name, True, elapsed, False) )
+                _pyabc.snapshot_restore(snapshot)
+                result = (name, status)
+                break
+
+            updates.append( (name, False, elapsed, uid in timed_out) )
+
+            if pending:
+                start_next()
+            elif not running:
+                break
+
+    # the engines killed because another one won, or by the global timeout, say nothing about
+    # their own performance and are not recorded
+
+    if updates:
+        store.update(key, updates)
+
+    return result
@@ -0,0 +1,581 @@
+"""
+module pyabc.remote
+
+Run split jobs on worker daemons instead of local child processes.
+
+A worker daemon is a pyabc.exe process running the pyabc_worker command:
+
+    PYABC_REMOTE_KEY=... pyabc.exe -c "pyabc_worker localhost:9000"
+    pyabc.exe -c "pyabc_worker unix:/tmp/pyabc.sock"
+
+Every message is authenticated with an HMAC-SHA256 of a shared secret, checked before anything is
+unpickled or any large payload is read, and bound to a random challenge sent by the worker for the
+connection, so that a captured request or response cannot be replayed. The secret is the `key` argument, or PYABC_REMOTE_KEY, or the contents of the file named by
+PYABC_REMOTE_KEY_FILE. A worker listening on TCP refuses to start without one. A UNIX socket is
+only accessible to its owner, and may be used without a secret. A TCP address without a host
+(':9000' or '9000') binds to localhost.
+
+Each connection carries one job. The worker forks a process for the job, restores the network
+snapshot sent with it, executes it and returns the result together with a snapshot of the resulting
+network and status (including the counterexample).
+
+A job is either an ABC script (a string), or a tuple (f, args) where f is a picklable (module level)
+function.
+
+Function: remote_split_all_full(jobs, endpoints, timeout=None, key=None)
+
+Runs the jobs on the endpoints and yields (i, (result, snapshot)) as they complete, where i is the
+index of the job. An endpoint is an address, or a tuple (address, slots) to run at most `slots` jobs
+on it at a time. Each job goes to the endpoint with a free slot that runs the fewest jobs, the
+others wait for a slot to free up.
+
+Function: abc_remote_split_all(jobs, endpoints, timeout=None, key=None)
+
+Like remote_split_all_full(), but restores the network and status of each job before yielding (i, result).
+
+Usage:
+
+    for i, res in abc_remote_split_all( ['pdr', 'bmc3'], ['localhost:9000', 'localhost:9001'] ):
+        print i, res, pyabc.prob_status()
+        break
+
+Wire format: on connection, the worker sends a 16-byte random challenge. A frame is a 4-byte
+big-endian payload length, a 32-byte HMAC of a direction tag, the challenge and the payload, and the
+payload. The request is a frame holding the sizes and SHA-256 digests of the raw snapshot (empty for
+none) and of the pickled job, followed by the snapshot and the job themselves. The worker reads the
+request frame only if it has the expected size, and the snapshot and the job only if the frame is
+authentic and their sizes are below its limit, with a timeout on the whole request. The response is
+a frame holding a pickled dict. The client keeps its side of the connection open until it has read
+the response; closing it cancels the job.
+"""
+
+import os
+import sys
+import hmac
+import errno
+import select
+import socket
+import struct
+import hashlib
+import threading
+import traceback
+import collections
+
+import cStringIO
+import pickle
+
+import _pyabc
+
+import split
+
+
+def _parse_address(address):
+
+    if address.startswith('unix:'):
+        return socket.AF_UNIX, address[5:]
+
+    if address.startswith('/'):
+        return socket.AF_UNIX, address
+
+    if ':' not in address:
+        return socket.AF_INET, ('localhost', int(address))
+
+    host, port = address.rsplit(':', 1)
+    return socket.AF_INET, (host or 'localhost', int(port))
+
+
+def _default_key():
+
+    key = os.environ.get('PYABC_REMOTE_KEY')
+
+    if key:
+        return key
+
+    path = os.environ.get('PYABC_REMOTE_KEY_FILE')
+
+    if path:
+        with open(path) as f:
+            return f.read().strip()
+
+    return None
+
+
+_REQUEST = 'Q'
+_RESPONSE = 'R'
+
+_CHALLENGE_SIZE = 16
+
+# the largest snapshot or job a worker accepts, and the time a client has to send its request
+MAX_REQUEST_SIZE = 1 << 30
+REQUEST_TIMEOUT = 60.0
+
+_header = struct.Struct('!I32s')
+
+# snapshot size, job size, snapshot digest, job digest
+_request = struct.Struct('!II32s32s')
+
+
+def _mac(key, tag, challenge, payload):
+
+    return hmac.new(key or '', tag + challenge + payload, hashlib.sha256).digest()
+
+
+def _frame(key, tag, challenge, payload):
+
+    return _header.pack(len(payload), _mac(key, tag, challenge, payload)) + payload
+
+
+def _check_frame(key, tag, challenge, mac, payload):
+
+    if not hmac.compare_digest(mac, _mac(key, tag, challenge, payload)):
+        raise ValueError('message authentication failed')
+
+    return payload
+
+
+def _request_frame(key, challenge, snapshot, snapshot_digest, job):
+
+    info = _request.pack(len(snapshot), len(job), snapshot_digest, hashlib.sha256(job).digest())
+    return _frame(key, _REQUEST, challenge, info)
+
+
+def _recv_all(sock, n):
+
+    chunks = []
+
+    while n > 0:
+        data = split.eintr_retry_call(sock.recv, min(n, 1 << 16))
+        if not data:
+            raise EOFError('connection closed')
+        chunks.append(data)
+        n -= len(data)
+
+    return ''.join(chunks)
+
+
+def _recv_digest(sock, n, digest):
+
+    data = _recv_all(sock, n)
+
+    if not hmac.compare_digest(hashlib.sha256(data).digest(), digest):
+        raise ValueError('message authentication failed')
+
+    return data
+
+
+def _recv_request(sock, key, challenge, max_size):
+
+    # the request frame has a fixed size, and the sizes it announces are authenticated before anything
+    # larger is read
+
+    n, mac = _header.unpack( _recv_all(sock, _header.size) )
+
+    if n != _request.size:
+        raise ValueError('malformed request')
+
+    info = _check_frame( key, _REQUEST, challenge, mac, _recv_all(sock, n) )
+    snapshot_size, job_size, snapshot_digest, job_digest = _request.unpack(info)
+
+    if snapshot_size > max_size or job_size > max_size:
+        raise ValueError('request too large')
+
+    snapshot = _recv_digest(sock, snapshot_size, snapshot_digest)
+    job = _recv_digest(sock, job_size, job_digest)
+
+    return snapshot, job
+
+
+def _watch_connection(sock):
+
+    # the client closes the connection to cancel the job
+
+    try:
+        while split.eintr_retry_call(sock.recv, 1):
+            pass
+    except socket.error:
+        pass
+
+    os._exit(1)
+
+
+def _run_job(conn, key, max_size, timeout):
+
+    # a peer that does not complete an authentic request in time is dropped, nothing is unpickled before
+
+    conn.settimeout(timeout)
+
+    challenge = os.urandom(_CHALLENGE_SIZE)
+    conn.sendall(challenge)
+
+    snapshot, job = _recv_request(conn, key, challenge, max_size)
+
+    conn.settimeout(None)
+
+    job = pickle.loads(job)
+
+    watcher = threading.Thread(target=_watch_connection, args=(conn,))
+    watcher.daemon = True
+    watcher.start()
+
+    response = {}
+
+    try:
+        if snapshot:
+            _pyabc.snapshot_restore(snapshot)
+
+        if isinstance(job, str):
+            result = _pyabc.run_command(job)
+        else:
+            f, args = job
+            result = f(*args)
+
+        response['result'] = result
+        response['snapshot'] = _pyabc.snapshot_save()
+
+    except Exception:
+        response['error'] = traceback.format_exc()
+
+    sys.stdout.flush()
+    sys.stderr.flush()
+
+    conn.sendall( _frame(key, _RESPONSE, challenge, pickle.dumps(response, pickle.HIGHEST_PROTOCOL)) )
+
+
+def _reap_children(children, block):
+
+    while children:
+
+        pid, status = split.eintr_retry_call(os.waitpid, -1, 0 if block else os.WNOHANG)
+
+        if pid == 0:
+            return
+
+        children.discard(pid)
+        block = False
+
+
+def serve(address, max_jobs=None, key=None, max_size=MAX_REQUEST_SIZE, timeout=REQUEST_TIMEOUT):
+    """
+    Accept jobs on address ('host:port', 'unix:path' or an absolute path) forever.
+    At most max_jobs jobs are executed concurrently. Jobs are authenticated with key, by default
+    the one from the environment (see the module documentation). Snapshots and jobs larger than
+    max_size bytes are refused, and a connection that does not send its request within timeout
+    seconds is closed.
+    """
+
+    family, addr = _parse_address(address)
+
+    if key is None:
+        key = _default_key()
+
+    if family == socket.AF_INET and not key:
+        raise ValueError('pyabc_worker: a key is required on a TCP address, set PYABC_REMOTE_KEY or PYABC_REMOTE_KEY_FILE')
+
+    sock = socket.socket(family, socket.SOCK_STREAM)
+    split._set_close_on_exec(sock.fileno())
+
+    if family == socket.AF_INET:
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+
+    # the socket file of a UNIX address is only accessible to its owner
+    umask = os.umask(0077)
+
+    try:
+        sock.bind(addr)
+    finally:
+        os.umask(umask)
+
+    sock.listen(128)
+
+    children = set()
+
+    try:
+        while True:
+
+            conn, _ = split.eintr_retry_call(sock.accept)
+
+            _reap_children(children, block=False)
+
+            while max_jobs and len(children) >= max_jobs:
+                _reap_children(children, block=True)
+
+            pid = os.fork()
+
+            if pid == 0:
+                rc = 1
+                try:
+                    sock.close()
+                    _run_job(conn, key, max_size, timeout)
+                    rc = 0
+                finally:
+                    os._exit(rc)
+
+            conn.close()
+            children.add(pid)
+
+    finally:
+        sock.close()
+        if family == socket.AF_UNIX:
+            os.unlink(addr)
+
+
+class remote_job_handler(split.base_handler):
+    """
+    A job executed by a worker daemon. The result is (result, snapshot), or None if the job failed.
+    Connecting, reading the challenge and sending the request do not block, they progress as the
+    socket becomes ready.
+    """
+
+    def __init__(self, loop, address, snapshot, snapshot_digest, job, key):
+
+        super(remote_job_handler, self).__init__(loop)
+        self.buf = cStringIO.StringIO()
+
+        self.address = address
+        self.snapshot = snapshot
+        self.snapshot_digest = snapshot_digest
+        self.job = job
+        self.key = key
+
+        self.challenge = None
+        self.frames = None
+        self.offset = 0
+
+        self.token = None
+        self.sock = None
+        self.done = False
+
+    def start(self):
+
+        family, addr = _parse_address(self.address)
+
+        self.sock = socket.socket(family, socket.SOCK_STREAM)
+        split._set_close_on_exec(self.sock.fileno())
+        _pyabc.atfork_child_add(self.sock.fileno())
+
+        self.sock.setblocking(0)
+
+        rc = self.sock.connect_ex(addr)
+
+        if rc not in (0, errno.EINPROGRESS, errno.EAGAIN):
+            self.fail()
+            return
+
+        # wait for the challenge, a failed connection is reported as a hangup or an error
+        self.loop.register(self, self.sock.fileno(), select.EPOLLIN)
+
+    def on_ready(self, fd):
+
+        while self.frames:
+
+            data = self.frames[0]
+
+            try:
+                n = self.sock.send( buffer(data, self.offset) )
+            except socket.error as e:
+                if e.errno in (errno.EAGAIN, errno.EWOULDBLOCK, errno.EINTR):
+                    return
+                self.fail()
+                return
+
+            self.offset += n
+
+            if self.offset < len(data):
+                return
+
+            self.frames.pop(0)
+            self.offset = 0
+
+        # the request is sent, only wait for the response
+        self.loop.unregister(fd)
+        self.loop.register(self, fd, select.EPOLLIN)
+
+    def on_data(self, fd, data):
+
+        self.buf.write(data)
+
+        if self.challenge is not None or self.buf.tell() < _CHALLENGE_SIZE:
+            return
+
+        # the challenge is in, send the request bound to it
+
+        data = self.buf.getvalue()
+
+        self.challenge = data[:_CHALLENGE_SIZE]
+        self.buf = cStringIO.StringIO()
+        self.buf.write(data[_CHALLENGE_SIZE:])
+
+        request = _request_frame(self.key, self.challenge, self.snapshot, self.snapshot_digest, self.job)
+        self.frames = [ request, self.snapshot, self.job ]
+        self.snapshot = self.job = None
+
+        self.loop.unregister(fd)
+        self.loop.register(self, fd, select.EPOLLOUT)
+
+    def on_hangup(self, fd):
+
+        if self.sock is None:
+            return
+
+        self.close()
+
+        data = self.buf.getvalue()
+        result = None
+
+        try:
+            if self.challenge is not None and len(data) >= _header.size:
+                n, mac = _header.unpack_from(data)
+                payload = _check_frame( self.key, _RESPONSE, self.challenge, mac, data[_header.size:_header.size + n] )
+                response = pickle.loads(payload)
+                if 'error' in response:
+                    sys.stderr.write(response['error'])
+                else:
+                    result = (response['result'], response['snapshot'])
+        except (EOFError, pickle.UnpicklingError, ValueError):
+            pass
+
+        self.report(result)
+
+    def on_error(self, fd):
+
+        self.on_hangup(fd)
+
+    def fail(self):
+
+        self.close()
+        self.report(None)
+
+    def report(self, result):
+
+        if not self.done:
+            self.done = True
+            self.frames = self.snapshot = self.job = None
+            self.loop.add_result((self.token, True, result))
+
+    def close(self):
+
+        if self.sock is not None:
+            fd = self.sock.fileno()
+            if fd in self.loop.fd_to_handler:
+                self.loop.unregister(fd)
+            _pyabc.atfork_child_remove(fd)
+            self.sock.close()
+            self.sock = None
+
+    def kill(self):
+
+        # closing the connection makes the worker abandon the job
+
+        if self.sock is not None:
+            try:
+                self.sock.shutdown(socket.SHUT_RDWR)
+            except socket.error:
+                pass
+
+    def detach(self):
+
+        self.close()
+        return True
+
+
+def remote_split_all_full(jobs, endpoints, timeout=None, key=None):
+
+    if key is None:
+        key = _default_key()
+
+    # the snapshot and its digest are computed once and shared by all the requests
+    snapshot = _pyabc.snapshot_save() or ''
+    snapshot_digest = hashlib.sha256(snapshot).digest()
+
+    endpoints = [ e if isinstance(e, tuple) else (e, None) for e in endpoints ]
+    running = [ 0 ] * len(endpoints)
+
+    pending = collections.deque( enumerate(jobs) )
+    uid_to_job = {}     # uid -> (job index, endpoint index)
+
+    with split.make_splitter() as s:
+
+        def start_pending():
+
+            while pending:
+
+                free = [ k for k, (_, slots) in enumerate(endpoints) if slots is None or running[k] < slots ]
+
+                if not free:
+                    return
+
+                k = min( free, key=lambda k: running[k] )
+                i, job = pending.popleft()
+
+                data = pickle.dumps(job, pickle.HIGHEST_PROTOCOL)
+                uid = s.start_handler( remote_job_handler(s.loop, endpoints[k][0], snapshot, snapshot_digest, data, key) )
+
+                uid_to_job[uid] = (i, k)
+                running[k] += 1
+
+        start_pending()
+
+        timer_uid = None
+
+        if timeout:
+            timer_uid = s.add_timer(timeout)
+
+        for uid, res in s:
+
+            if uid == timer_uid:
+                break
+
+            if uid not in uid_to_job:
+                continue
+
+            i, k = uid_to_job.pop(uid)
+            running[k] -= 1
+
+            start_pending()
+
+            yield i, res
+
+
+def abc_remote_split_all(jobs, endpoints, timeout=None, key=None):
+
+    for i, res in remote_split_all_full(jobs, endpoints, timeout, key):
+
+        if res is None:
+            yield i, None
+            continue
+
+        result, snapshot = res
+
+        if snapshot is not None:
+            _pyabc.snapshot_restore(snapshot)
+
+        yield i, result
+
+
+def cmd_pyabc_worker(cmd_args):
+
+    import optparse
+
+    usage = "usage: %prog [options] <address>"
+
+    parser = optparse.OptionParser(usage, prog="pyabc_worker")
+    parser.add_option("-j", "--jobs", dest="jobs", type="int", default=None, help="maximal number of concurrent jobs")
+    parser.add_option("-k", "--key-file", dest="key_file", default=None, help="a file holding the shared secret of the clients")
+    parser.add_option("-m", "--max-size", dest="max_size", type="int", default=MAX_REQUEST_SIZE, help="the largest snapshot or job accepted, in bytes")
+    parser.add_option("-t", "--timeout", dest="timeout", type="float", default=REQUEST_TIMEOUT, help="seconds a client has to send its request")
+
+    options, args = parser.parse_args(cmd_args)
+
+    if len(args) != 2:
+        parser.print_usage()
+        return 1
+
+    key = None
+
+    if options.key_file:
+        with open(options.key_file) as f:
+            key = f.read().strip()
+
+    serve(args[1], options.jobs, key, options.max_size, options.timeout)
+
+    return 0
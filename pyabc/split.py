@@ -58,7 +58,9 @@ for res in split_all(funcs):
     print res
     break
 
-This will kill all processes not yet finished.
+This will kill all processes not yet finished. Each process runs in its own process group, so the
+processes it started are killed with it, and the parent does not wait for them to exit: they are
+reaped by the next split.
 
 To run ABC operations, that required saving the child process state and restoring it at the parent, use abc_split_all().
 
@@ -95,6 +97,8 @@ from contextlib import contextmanager
 
 import cStringIO
 import pickle
+import struct
+import zlib
 
 import traceback
 
@@ -129,6 +133,17 @@ def eintr_retry_nonblocking(f, *args, **kwds):
                 raise
 
 
+def _read_chunk(fd):
+
+    try:
+        return eintr_retry_nonblocking(os.read, fd, 1 << 16)
+    except OSError as e:
+        # a socket reset by its peer, or whose connection failed, ends like a closed one
+        if e.errno not in (errno.ECONNRESET, errno.ECONNREFUSED, errno.ETIMEDOUT, errno.EHOSTUNREACH, errno.ENETUNREACH):
+            raise
+        return ''
+
+
 def _set_non_blocking(fd):
     fcntl.fcntl( fd, fcntl.F_SETFL, fcntl.fcntl(fd, fcntl.F_GETFL) | os.O_NONBLOCK )
 
@@ -153,6 +168,246 @@ def _pipe(blocking_read=True, blocking_write=True):
     return pr, pw
 
 
+def _own_cgroup():
+
+    # the cgroup v2 directory of the current process, or None if cgroup v2 is not available
+
+    try:
+        with open('/proc/self/cgroup') as f:
+            for line in f:
+                hid, controllers, path = line.rstrip('\n').split(':', 2)
+                if hid == '0':
+                    return os.path.join('/sys/fs/cgroup', path.lstrip('/'))
+    except (IOError, ValueError):
+        pass
+
+    return None
+
+
+def _cgroup_kill(cgroup):
+
+    # kill every process of a cgroup with a single write, False if cgroup.kill is not available (before Linux 5.14)
+
+    try:
+        with open(os.path.join(cgroup, 'cgroup.kill'), 'w') as f:
+            f.write('1\n')
+        return True
+    except IOError:
+        return False
+
+
+def _kill_job_tree(pid, h):
+
+    # kill whatever is left of a job after its own process exited, before it is reaped: until then its
+    # pid, which names the process group, cannot be reused
+
+    if h.cgroup and _cgroup_kill(h.cgroup):
+        return
+
+    if h.job_group:
+        try:
+            os.killpg(pid, signal.SIGKILL)
+        except OSError as e:
+            if e.errno not in (errno.ESRCH, errno.EPERM):
+                raise
+
+
+def _reap_job(pid, h):
+
+    # if the process of a job exited, kill the rest of the job, reap the process and return (status, rusage)
+
+    if not _pyabc.child_exited(pid):
+        return None
+
+    _kill_job_tree(pid, h)
+
+    rc, status, rusage = eintr_retry_call( os.wait4, pid, os.WNOHANG )
+
+    if h.limits:
+        h.limits.release(h.cgroup)
+
+    return status, rusage
+
+
+# pid -> handler of the children killed by _splitter.cleanup() that are not reaped yet
+_orphans = {}
+
+
+def _reap_orphans():
+
+    for pid, h in _orphans.items():
+
+        try:
+            res = _reap_job(pid, h)
+        except OSError as e:
+            if e.errno != errno.ECHILD:
+                raise
+            # reaped by someone else, the pid may already be reused
+            del _orphans[pid]
+            if h.limits:
+                h.limits.release(h.cgroup)
+            continue
+
+        if res is not None:
+            del _orphans[pid]
+
+
+def _cgroup_delegates_memory(cgroup):
+
+    # True if job cgroups with memory.max can be created under cgroup
+
+    try:
+        with open(os.path.join(cgroup, 'cgroup.subtree_control')) as f:
+            return 'memory' in f.read().split() and os.access(cgroup, os.W_OK)
+    except IOError:
+        return False
+
+
+def _cgroup_move_self(cgroup):
+
+    with open(os.path.join(cgroup, 'cgroup.procs'), 'w') as f:
+        f.write('0\n')
+
+
+class job_limits(object):
+    """
+    Resource limits for forked jobs.
+
+    cpu: CPU time limit in seconds (RLIMIT_CPU).
+    memory: memory limit in bytes. Enforced by a per-job cgroup v2 (memory.max) when a cgroup with
+        the memory controller is available (see _cgroup_root()), and by RLIMIT_AS otherwise.
+    cpus: a list of CPUs the job may run on, by default all CPUs available to the parent.
+    pin: if True, pin each job to a single CPU out of cpus, round robin.
+    """
+
+    def __init__(self, cpu=None, memory=None, cpus=None, pin=False, use_cgroup=True):
+
+        self.cpu = cpu
+        self.memory = memory
+        self.cpus = cpus
+        self.pin = pin
+
+        self.cgroup_root = None
+
+        if memory and use_cgroup:
+            self.cgroup_root = self._cgroup_root()
+
+        if pin and not self.cpus:
+            self.cpus = _pyabc.get_cpu_affinity()
+
+    # the parent of the job cgroups, found once per process: False until it is looked for
+    _cgroup_root_cache = False
+
+    @staticmethod
+    def _cgroup_root():
+
+        if job_limits._cgroup_root_cache is False:
+            job_limits._cgroup_root_cache = job_limits._find_cgroup_root()
+
+        return job_limits._cgroup_root_cache
+
+    @staticmethod
+    def _find_cgroup_root():
+
+        # A cgroup v2 with processes of its own cannot enable controllers for its children (the
+        # no-internal-processes rule), so the cgroup of this process is never usable as it is.
+        # Either PYABC_CGROUP names a delegated cgroup with the memory controller enabled for its
+        # children, or this process moves into a leaf child of its own cgroup, which is then free to
+        # enable the memory controller for the job cgroups next to that leaf.
+
+        root = os.environ.get('PYABC_CGROUP')
+
+        if root:
+            return root if _cgroup_delegates_memory(root) else None
+
+        root = _own_cgroup()
+
+        if root is None or not os.access(root, os.W_OK):
+            return None
+
+        if _cgroup_delegates_memory(root):
+            return root
+
+        try:
+            with open(os.path.join(root, 'cgroup.controllers')) as f:
+                if 'memory' not in f.read().split():
+                    return None
+        except IOError:
+            return None
+
+        leaf = os.path.join(root, 'pyabc-%d'%os.getpid())
+
+        try:
+            os.mkdir(leaf)
+        except OSError:
+            return None
+
+        try:
+            _cgroup_move_self(leaf)
+        except IOError:
+            os.rmdir(leaf)
+            return None
+
+        try:
+            with open(os.path.join(root, 'cgroup.subtree_control'), 'w') as f:
+                f.write('+memory\n')
+            return root
+        except IOError:
+            # other processes share the cgroup, go back where we were
+            try:
+                _cgroup_move_self(root)
+                os.rmdir(leaf)
+            except (IOError, OSError):
+                pass
+            return None
+
+    def prepare(self, uid):
+        """ create the cgroup for job uid in the parent, return its path or None """
+
+        if not self.cgroup_root:
+            return None
+
+        path = os.path.join(self.cgroup_root, 'pyabc-%d-%d'%(os.getpid(), uid))
+
+        try:
+            os.mkdir(path)
+            with open(os.path.join(path, 'memory.max'), 'w') as f:
+                f.write('%d\n'%self.memory)
+            return path
+        except (IOError, OSError):
+            self.release(path)
+            return None
+
+    def apply(self, uid, cgroup):
+        """ apply the limits in the child process """
+
+        import resource
+
+        if self.cpu:
+            resource.setrlimit(resource.RLIMIT_CPU, (self.cpu, self.cpu))
+
+        if cgroup:
+            with open(os.path.join(cgroup, 'cgroup.procs'), 'w') as f:
+                f.write('0\n')
+        elif self.memory:
+            resource.setrlimit(resource.RLIMIT_AS, (self.memory, self.memory))
+
+        if self.cpus:
+            cpus = self.cpus
+            if self.pin:
+                cpus = [ cpus[uid % len(cpus)] ]
+            _pyabc.set_cpu_affinity(cpus)
+
+    def release(self, cgroup):
+        """ remove the cgroup of a job that has been reaped """
+
+        if cgroup:
+            try:
+                os.rmdir(cgroup)
+            except OSError:
+                pass
+
+
 class _unique_ids(object):
 
     def __init__(self):
@@ -170,6 +425,10 @@ class base_handler(object):
 
     def __init__(self, loop):
         self.loop = loop
+        self.limits = None
+        self.cgroup = None
+        self.rusage = None
+        self.job_group = False
 
     def on_data(self, fd, data):
         pass
@@ -186,6 +445,10 @@ class base_handler(object):
     def kill(self):
         pass
 
+    def detach(self):
+        """ stop watching a killed job without waiting for it to finish, False if not supported """
+        return False
+
 
 class event_loop(object):
 
@@ -234,10 +497,16 @@ class event_loop(object):
 
     def poll(self):
 
-        for res in self.iter_results():
-            yield res
+        while True:
 
-        while self.keep_alive_fds:
+            # results may also be added while the caller handles the previous ones
+            for res in self.iter_results():
+                yield res
+
+            if not self.keep_alive_fds:
+                if self.results:
+                    continue
+                return
 
             for fd, event in eintr_retry_call( self.epoll.poll ):
 
@@ -245,9 +514,17 @@ class event_loop(object):
                 h = self.fd_to_handler[fd]
 
                 if event & select.EPOLLIN:
-                    data = eintr_retry_nonblocking(os.read, fd, 1 << 16)
-                    if data:
+                    data = _read_chunk(fd)
+                    while data:
+                        _pyabc.metrics_add_split_bytes(len(data))
                         h.on_data(fd, data)
+                        # on hangup, drain the fd before on_hangup() closes it
+                        if not event & select.EPOLLHUP:
+                            break
+                        data = _read_chunk(fd)
+                    if data == '':
+                        # end of file without EPOLLHUP, e.g. a socket shut down by the peer
+                        event |= select.EPOLLHUP
 
                 if event & select.EPOLLOUT:
                     h.on_ready(fd)
@@ -258,9 +535,6 @@ class event_loop(object):
                 if event & select.EPOLLERR:
                     h.on_error(fd)
 
-            for res in self.iter_results():
-                yield res
-
     def close(self):
 
         self.epoll.close()
@@ -325,6 +599,10 @@ class timer_manager(signal_event_handler):
 
     def stop(self):
 
+        # a pending alarm must not reach the default handler once it is restored
+        if self.timers and not callable(self.old_signal):
+            signal.setitimer(signal.ITIMER_REAL, 0)
+
         self.timers = []
         super(timer_manager, self).stop()
 
@@ -352,6 +630,13 @@ class timer_manager(signal_event_handler):
 
 class process_manager(signal_event_handler):
 
+    # return free heap memory to the system before each fork, so that children start smaller. Trimming
+    # walks the whole heap, _splitter.fork_all() does it once per batch instead.
+    trim_before_fork = False
+
+    # run each child in its own process group, so that it is killed with the processes it started
+    job_groups = True
+
     def __init__(self, loop):
 
         super(process_manager, self).__init__(loop)
@@ -360,7 +645,7 @@ class process_manager(signal_event_handler):
     def _install_signal_handler(self, fd):
         _pyabc.add_sigchld_fd(fd);
 
-    def _uninstall_signal_handler(seld):
+    def _uninstall_signal_handler(self, fd):
         _pyabc.remove_sigchld_fd(fd)
 
     def kill_all(self):
@@ -372,19 +657,44 @@ class process_manager(signal_event_handler):
 
         super(process_manager, self).stop()
 
+    def detach(self):
+
+        # hand the children still running to _reap_orphans(), and stop watching SIGCHLD
+
+        _orphans.update(self.pid_to_handler)
+        self.pid_to_handler = {}
+
+        self.clean()
+
     def fork(self, h):
 
+        _reap_orphans()
+
         h.on_fork(self)
 
+        if h.limits:
+            h.cgroup = h.limits.prepare(h.token)
+
+        if self.trim_before_fork:
+            _pyabc.allocator_trim()
+
         ppid = os.getpid()
         rc = 1
 
         try:
             pid = os.fork()
             if pid == 0:
+                _orphans.clear()
+                if self.job_groups:
+                    _pyabc.job_group_start()
+                if h.limits:
+                    h.limits.apply(h.token, h.cgroup)
                 rc = h.on_child()
                 os._exit(rc)
             else:
+                if self.job_groups:
+                    self._set_job_group(pid)
+                    h.job_group = True
                 self.register()
                 self.pid_to_handler[pid] = h
                 h.on_parent(pid)
@@ -394,14 +704,28 @@ class process_manager(signal_event_handler):
                 os._exit(rc)
 
 
+    @staticmethod
+    def _set_job_group(pid):
+
+        # the child does the same, whichever runs first creates the group before anyone signals it
+
+        try:
+            os.setpgid(pid, pid)
+        except OSError as e:
+            # EACCES: the child already called exec(), after joining its group
+            if e.errno not in (errno.EACCES, errno.ESRCH):
+                raise
+
     def _reap(self):
 
         for pid, h in self.pid_to_handler.items():
-            rc, status = eintr_retry_call( os.waitpid, pid, os.WNOHANG )
-            if rc > 0:
+            res = _reap_job(pid, h)
+            if res is not None:
+                status, rusage = res
                 del self.pid_to_handler[pid]
                 if not self.pid_to_handler:
                     self.unregister()
+                h.rusage = rusage
                 h.on_waitpid(status)
 
 
@@ -493,17 +817,116 @@ class forked_process_handler(base_handler):
 
     def kill(self):
 
+        # the child leads its process group, and kills the group on SIGQUIT
         if self.pid is not None:
             os.kill(self.pid, signal.SIGQUIT)
 
+    def detach(self):
+
+        if self.pr is not None:
+            self.loop.unregister(self.pr)
+            _pyabc.atfork_child_remove(self.pr)
+            os.close(self.pr)
+            self.pr = None
+
+        return True
+
+
+class zygote_process_handler(base_handler):
+    """
+    Run an ABC script in a worker forked by the fork-server (see _pyabc.zygote_fork()).
+    The worker is not a child of this process, so termination is detected by EOF on the result pipe.
+    The result is a tuple (rc, snapshot), or None if the worker died before reporting.
+    """
+
+    def __init__(self, loop, script):
+
+        super(zygote_process_handler, self).__init__(loop)
+        self.buf = cStringIO.StringIO()
+
+        self.script = script
+        self.token = None
+        self.pid = None
+        self.pr = None
+
+    def start(self):
+
+        pr, pw = _pipe(blocking_read=False)
+
+        try:
+            pid = _pyabc.zygote_fork(self.script, pw)
+        finally:
+            os.close(pw)
+
+        if pid < 0:
+            os.close(pr)
+            raise RuntimeError('fork-server failed to start a worker')
+
+        self.pid = pid
+        self.pr = pr
+
+        self.loop.register(self, pr)
+        _pyabc.atfork_child_add(pr)
+
+    def on_data(self, fd, data):
+
+        assert fd == self.pr
+        self.buf.write(data)
+
+    def on_hangup(self, fd):
+
+        assert fd == self.pr
+        self.loop.unregister(fd)
+        _pyabc.atfork_child_remove(fd)
+        os.close(fd)
+        self.pr = None
+        self.pid = None
+
+        data = self.buf.getvalue()
+        result = None
+
+        if len(data) >= 4:
+            rc, = struct.unpack('i', data[:4])
+            result = (rc, data[4:])
+
+        self.loop.add_result((self.token, True, result))
+
+    def kill(self):
+
+        # the worker is a child of the fork-server, which reaps it, so its pid may already be reused here
+        if self.pid is not None:
+            _pyabc.zygote_kill(self.pid)
+
+    def detach(self):
+
+        # the worker is a child of the fork-server, which reaps it
+
+        if self.pr is not None:
+            self.loop.unregister(self.pr)
+            _pyabc.atfork_child_remove(self.pr)
+            os.close(self.pr)
+            self.pr = None
+            self.pid = None
+
+        return True
+
+
 class _splitter(object):
 
+    # return free heap memory to the system once before fork_all() forks its batch
+    trim_before_batch = True
+
     def __init__(self):
 
+        _reap_orphans()
+
         self.uids = _unique_ids()
         self.uid_to_handler = {}
         self.handler_to_uid = {}
 
+        self.uid_to_rusage = {}
+        self.teardown_time = None
+
         self.loop = event_loop()
         self.timers = timer_manager(self.loop)
         self.procs = process_manager(self.loop)
@@ -521,10 +944,11 @@ class _splitter(object):
 
         return self.fork_handler( forked_process_handler(self.loop, child) )
 
-    def fork_handler(self, h):
+    def fork_handler(self, h, limits=None):
 
         uid = self.uids.allocate()
         h.token = uid
+        h.limits = limits
 
         self.procs.fork(h)
 
@@ -533,9 +957,34 @@ class _splitter(object):
 
         return uid
 
-    def fork_all(self, funcs):
+    def fork_all(self, funcs, limits=None):
+
+        if self.trim_before_batch and not self.procs.trim_before_fork:
+            _pyabc.allocator_trim()
+
+        return [ self.fork_handler(forked_process_handler(self.loop, f), limits) for f in funcs ]
 
-        return [ self.fork_one(f) for f in funcs ]
+    def start_handler(self, h):
+
+        # start a handler that is not a child of this process (it has a start() method instead of on_child())
+
+        uid = self.uids.allocate()
+        h.token = uid
+
+        h.start()
+
+        self.uid_to_handler[uid] = h
+        self.handler_to_uid[h] = uid
+
+        return uid
+
+    def zygote_one(self, script):
+
+        return self.start_handler( zygote_process_handler(self.loop, script) )
+
+    def zygote_all(self, scripts):
+
+        return [ self.zygote_one(script) for script in scripts ]
 
     def kill(self, uid):
         
@@ -543,12 +992,40 @@ class _splitter(object):
             self.uid_to_handler[uid].kill()
 
     def cleanup(self):
+        """
+        Kill the jobs still running, and return without waiting for them to exit. Their results are
+        dropped. The children that already exited are reaped before it returns, the others later, by
+        _reap_orphans().
+        """
+
+        start = time.time()
+
+        handlers = self.uid_to_handler.values()
 
-        for uid, h in self.uid_to_handler.iteritems():
+        for h in handlers:
             h.kill()
 
-        for _ in self.results():
-            pass
+        attached = [ h for h in handlers if not h.detach() ]
+
+        self.procs.detach()
+        self.timers.stop()
+
+        # handlers that cannot be detached are drained, as before
+        if attached:
+            for _ in self.results():
+                pass
+
+        self.uid_to_handler = {}
+        self.handler_to_uid = {}
+
+        self.loop.close()
+
+        _reap_orphans()
+
+        self.teardown_time = time.time() - start
+
+        if handlers:
+            _pyabc.metrics_add_split_teardown( len(handlers), int(self.teardown_time * 1e9) )
 
     def results(self):
 
@@ -561,8 +1038,16 @@ class _splitter(object):
                 del self.uid_to_handler[uid]
                 del self.handler_to_uid[h]
 
+                if h.rusage is not None:
+                    self.uid_to_rusage[uid] = h.rusage
+
             yield uid, res
 
+    def rusage(self, uid):
+        """ return the resource usage of a finished job (see os.wait4), or None if not available """
+
+        return self.uid_to_rusage.pop(uid, None)
+
     def __iter__(self):
 
         def iterator():
@@ -583,13 +1068,149 @@ def make_splitter(*args, **kwargs):
         s.cleanup()
 
 
+class output_capture(object):
+    """
+    A bounded capture of a child's output: the first `head` bytes, and the last `tail` bytes in a
+    ring buffer. With spill=True, the bytes pushed out of the ring buffer are kept zlib-compressed,
+    up to `max_spill` compressed bytes. A callback, if given, is called with every chunk as it
+    arrives. Memory use is bounded regardless of how much the child writes.
+    """
+
+    def __init__(self, head=4096, tail=65536, spill=False, max_spill=1<<20, callback=None):
+
+        self.head_size = head
+        self.head = bytearray()
+
+        self.ring = bytearray(tail)
+        self.ring_pos = 0
+        self.ring_len = 0
+
+        self.compressor = zlib.compressobj() if spill else None
+        self.spilled = []
+        self.spill_size = 0
+        self.max_spill = max_spill
+
+        self.callback = callback
+
+        self.total = 0
+        self.dropped = 0
+
+    def write(self, data):
+
+        self.total += len(data)
+
+        if self.callback:
+            self.callback(data)
+
+        if len(self.head) < self.head_size:
+            n = self.head_size - len(self.head)
+            self.head += data[:n]
+            data = data[n:]
+
+        if data:
+            self._ring_push(data)
+
+    def _ring_slice(self, start, n):
+
+        cap = len(self.ring)
+        start %= cap
+
+        if start + n <= cap:
+            return bytes(self.ring[start:start+n])
+
+        return bytes(self.ring[start:]) + bytes(self.ring[:n-(cap-start)])
+
+    def _ring_push(self, data):
+
+        cap = len(self.ring)
+        n = len(data)
+
+        evict = self.ring_len + n - cap
+
+        if evict > 0:
+
+            if self.compressor is None:
+                self.dropped += evict
+
+            elif evict <= self.ring_len:
+                self._spill( self._ring_slice(self.ring_pos - self.ring_len, evict) )
+
+            else:
+                self._spill( self._ring_slice(self.ring_pos - self.ring_len, self.ring_len) + data[:evict-self.ring_len] )
+
+        if cap == 0:
+            return
+
+        if n >= cap:
+            self.ring[:] = data[-cap:]
+            self.ring_pos = 0
+            self.ring_len = cap
+            return
+
+        first = min(n, cap - self.ring_pos)
+        self.ring[self.ring_pos:self.ring_pos+first] = data[:first]
+        self.ring[:n-first] = data[first:]
+
+        self.ring_pos = (self.ring_pos + n) % cap
+        self.ring_len = min(cap, self.ring_len + n)
+
+    def _spill(self, data):
+
+        if self.spill_size > self.max_spill:
+            self.dropped += len(data)
+            return
+
+        compressed = self.compressor.compress(data)
+
+        self.spilled.append(compressed)
+        self.spill_size += len(compressed)
+
+    def head_text(self):
+
+        return bytes(self.head)
+
+    def tail_text(self):
+
+        if not self.ring_len:
+            return ''
+
+        return self._ring_slice(self.ring_pos - self.ring_len, self.ring_len)
+
+    def spill_text(self):
+        """ the spilled bytes between the head and the tail, decompressed """
+
+        if self.compressor is None:
+            return ''
+
+        return zlib.decompress( ''.join(self.spilled) + self.compressor.copy().flush() )
+
+    def text(self):
+
+        omitted = self.total - len(self.head) - self.ring_len
+
+        if omitted > 0:
+            return '%s\n[... %d bytes omitted ...]\n%s'%(self.head_text(), omitted, self.tail_text())
+
+        return self.head_text() + self.tail_text()
+
+
 class base_redirect_handler(base_handler):
+    """
+    Runs f() in a child with its stdin and stdout redirected to pipes. The child's output goes to
+    `capture`, an output_capture (or anything with a write() method), and is discarded if it is None.
 
-    def __init__(self, loop, f):
+    At most `max_stdin_buffer` bytes are buffered for the child's stdin. write_stdin() returns False
+    when the buffer is full, and on_stdin_drained() is called once it drained. Alternatively,
+    feed_stdin() pulls chunks from an iterator only as fast as the child reads them.
+    """
+
+    def __init__(self, loop, f, capture=None, max_stdin_buffer=1<<20):
 
         super(base_redirect_handler, self).__init__(loop)
 
         self.f = f
+        self.capture = capture
+        self.max_stdin_buffer = max_stdin_buffer
         
         self.token = None
         self.pid = None
@@ -620,13 +1241,15 @@ class base_redirect_handler(base_handler):
         os.close(self.stdin_read)
         self.stdin_read = None
         self.stdin_buf = collections.deque()
+        self.stdin_buffered = 0
+        self.stdin_producer = None
+        self.stdin_registered = False
         self.should_close_stdin = False
 
         self.pid = pid
         self.path = None
         self.args = None
 
-        # self.loop.register(self, self.stdin_write)
         _pyabc.atfork_child_add(self.stdin_write)
 
         self.loop.register(self, self.stdout_read)
@@ -644,34 +1267,111 @@ class base_redirect_handler(base_handler):
 
         return self.f()
 
-    def on_ready(self, fd):
-        
-        assert fd == self.stdin_write
+    def on_data(self, fd, data):
+
+        if self.capture is not None:
+            self.capture.write(data)
+
+    def _flush_stdin(self):
+
+        # write as much of the buffer as the pipe takes, return True if the buffer is empty
 
         while self.stdin_buf:
 
             data = self.stdin_buf[0]
-            rc = eintr_retry_nonblocking(os.write, fd, data)
+
+            try:
+                rc = eintr_retry_nonblocking(os.write, self.stdin_write, data)
+            except OSError as e:
+                if e.errno != errno.EPIPE:
+                    raise
+                # the child closed its stdin, drop whatever is left
+                self.stdin_buf.clear()
+                self.stdin_buffered = 0
+                self.stdin_producer = None
+                return True
 
             if rc is None:
-                return
-            elif rc < len(data):
+                return False
+
+            self.stdin_buffered -= rc
+
+            if rc < len(data):
                 self.stdin_buf[0] = data[rc:]
-                return
+                return False
 
             self.stdin_buf.popleft()
 
-        self.loop.unregister(fd)
+        return True
+
+    def _pull_stdin(self):
+
+        # refill the buffer from the producer, up to the limit
+
+        while self.stdin_producer is not None and self.stdin_buffered < self.max_stdin_buffer:
+
+            try:
+                data = next(self.stdin_producer)
+            except StopIteration:
+                self.stdin_producer = None
+                self.close_stdin()
+                return
+
+            if data:
+                self.stdin_buf.append(data)
+                self.stdin_buffered += len(data)
+
+    def _update_stdin(self):
+
+        while True:
+
+            self._pull_stdin()
+
+            if not self._flush_stdin() or self.stdin_producer is None:
+                break
+
+        if self.stdin_buf and not self.stdin_registered:
+            self.loop.register(self, self.stdin_write, select.EPOLLOUT)
+            self.stdin_registered = True
+
+        elif not self.stdin_buf and self.stdin_registered:
+            self.loop.unregister(self.stdin_write)
+            self.stdin_registered = False
+
+    def on_ready(self, fd):
         
+        assert fd == self.stdin_write
+
+        full = self.stdin_buffered >= self.max_stdin_buffer
+
+        self._update_stdin()
+
+        if self.stdin_buf:
+            return
+
         if self.should_close_stdin:
             self.close_stdin()
+        elif full:
+            self.on_stdin_drained()
+
+    def on_stdin_drained(self):
+        pass
 
     def write_stdin(self, data):
+        """ queue data for the child's stdin, return False if the buffer is full and the caller should wait """
+
+        if data:
+            self.stdin_buf.append(data)
+            self.stdin_buffered += len(data)
+            self._update_stdin()
 
-        if data and not self.stdin_buf:
-            self.loop.register(self, self.stdin_write)
+        return self.stdin_buffered < self.max_stdin_buffer
 
-        self.stdin_buf.append(data)
+    def feed_stdin(self, producer):
+        """ write the chunks of an iterator to the child's stdin as it reads them, then close it """
+
+        self.stdin_producer = iter(producer)
+        self._update_stdin()
 
     def close_stdin(self):
 
@@ -679,15 +1379,22 @@ class base_redirect_handler(base_handler):
             self.should_close_stdin = True
             return
 
+        if self.stdin_registered:
+            self.loop.unregister(self.stdin_write)
+            self.stdin_registered = False
+
         _pyabc.atfork_child_remove(self.stdin_write)
         os.close( self.stdin_write )
+        self.stdin_write = None
         self.done_writing = True
 
     def on_hangup(self, fd):
 
         assert fd == self.stdout_read or fd == self.stdin_write
         
-        self.loop.unregister(fd)
+        if fd != self.stdin_write or self.stdin_registered:
+            self.loop.unregister(fd)
+
         _pyabc.atfork_child_remove(fd)
         os.close(fd)
 
@@ -698,6 +1405,7 @@ class base_redirect_handler(base_handler):
         if fd == self.stdin_write:
             self.done_writing = True
             self.stdin_write = None
+            self.stdin_registered = False
 
         self.on_done()            
 
@@ -718,7 +1426,9 @@ class base_redirect_handler(base_handler):
             return
 
         if not self.done_writing:
-            self.stdin_buf = None
+            self.stdin_buf.clear()
+            self.stdin_buffered = 0
+            self.stdin_producer = None
             self.close_stdin()
 
         self.loop.add_result((self.token, True, self.status))
@@ -728,9 +1438,29 @@ class base_redirect_handler(base_handler):
         if self.pid is not None:
             os.kill(self.pid, signal.SIGQUIT)
 
+    def detach(self):
+
+        if self.stdin_write is not None:
+            if self.stdin_registered:
+                self.loop.unregister(self.stdin_write)
+                self.stdin_registered = False
+            _pyabc.atfork_child_remove(self.stdin_write)
+            os.close(self.stdin_write)
+            self.stdin_write = None
+
+        if self.stdout_read is not None:
+            self.loop.unregister(self.stdout_read)
+            _pyabc.atfork_child_remove(self.stdout_read)
+            os.close(self.stdout_read)
+            self.stdout_read = None
+
+        return True
+
 
-def split_all_full(funcs, timeout=None):
+def split_all_full(funcs, timeout=None, limits=None, rusage=False):
     # provide an iterator for child process result
+    # limits: a job_limits object applied to each child
+    # rusage: if True, yield (uid, res, rusage) where rusage is the resource usage of the child
     with make_splitter() as s:
 
         timer_uid = None
@@ -738,7 +1468,42 @@ def split_all_full(funcs, timeout=None):
         if timeout:
             timer_uid = s.add_timer(timeout)
 
-        s.fork_all(funcs)
+        s.fork_all(funcs, limits)
+
+        for uid, res in s:
+
+            if uid == timer_uid:
+                break
+
+            if rusage:
+                yield uid, res, s.rusage(uid)
+            else:
+                yield uid, res
+
+
+def _script_child(script):
+    rc = _pyabc.run_command(script)
+    return rc, _pyabc.snapshot_save()
+
+
+def zygote_split_all_full(scripts, timeout=None):
+    """
+    Run each ABC script on a copy of the current network in a separate process, yielding (i, (rc, snapshot)).
+    If the fork-server is running (PYABC_ZYGOTE is set), the workers are forked from it instead of
+    from this process.
+    """
+
+    with make_splitter() as s:
+
+        if _pyabc.zygote_enabled():
+            s.zygote_all(scripts)
+        else:
+            s.fork_all( defer(_script_child)(script) for script in scripts )
+
+        timer_uid = None
+
+        if timeout:
+            timer_uid = s.add_timer(timeout)
 
         for uid, res in s:
 
@@ -748,6 +1513,25 @@ def split_all_full(funcs, timeout=None):
             yield uid, res
 
 
+def abc_zygote_split_all(scripts, timeout=None):
+    """
+    Like zygote_split_all_full(), but before yielding (i, rc), the network and status of script i are restored.
+    """
+
+    for i, res in zygote_split_all_full(scripts, timeout):
+
+        if res is None:
+            yield i, None
+            continue
+
+        rc, snapshot = res
+
+        if snapshot is not None:
+            _pyabc.snapshot_restore(snapshot)
+
+        yield i, rc
+
+
 def defer(f):
     return lambda *args, **kwargs: lambda : f(*args,**kwargs)
 
@@ -757,60 +1541,35 @@ def split_all(funcs, *args, **kwargs):
         yield res
 
 
-import tempfile
-
-
-@contextmanager
-def temp_file_names(suffixes):
-    names = []
-    try:
-        for suffix in suffixes:
-            with tempfile.NamedTemporaryFile(delete=False, suffix=suffix) as file:
-                names.append( file.name )
-        yield names
-    finally:
-        for name in names:
-            os.unlink(name)
-
-
 class abc_state(object):
     def __init__(self):
-        with tempfile.NamedTemporaryFile(delete=False, suffix='.aig') as file:
-            self.aig = file.name
-        with tempfile.NamedTemporaryFile(delete=False, suffix='.log') as file:
-            self.log = file.name
-        pyabc.run_command(r'write_status %s'%self.log)
-        pyabc.run_command(r'write_aiger %s'%self.aig)
-
-    def __del__(self):
-        os.unlink( self.aig )
-        os.unlink( self.log )
+        self.snapshot = _pyabc.snapshot_save()
 
     def restore(self):
-        pyabc.run_command(r'read_aiger %s'%self.aig)
-        pyabc.run_command(r'read_status %s'%self.log)
+        if self.snapshot is not None:
+            _pyabc.snapshot_restore(self.snapshot)
 
 
 def abc_split_all(funcs):
-    import pyabc
 
-    def child(f, aig, log):
+    # the children send back their network and status in memory, as part of their result
+
+    def child(f):
         res = f()
-        pyabc.run_command(r'write_status %s'%log)
-        pyabc.run_command(r'write_aiger %s'%aig)
-        return res
+        return res, _pyabc.snapshot_save()
 
-    def parent(res, aig, log):
-        pyabc.run_command(r'read_aiger %s'%aig)
-        pyabc.run_command(r'read_status %s'%log)
+    def parent(res):
+        if res is None:
+            return None
+        res, snapshot = res
+        if snapshot is not None:
+            _pyabc.snapshot_restore(snapshot)
         return res
 
-    with temp_file_names( ['.aig','.log']*len(funcs) ) as tmp:
-
-        funcs = [ defer(child)(f, tmp[2*i],tmp[2*i+1]) for i,f in enumerate(funcs) ]
+    funcs = [ defer(child)(f) for f in funcs ]
 
-        for i, res in split_all_full(funcs):
-            yield i, parent(res, tmp[2*i],tmp[2*i+1])
+    for i, res in split_all_full(funcs):
+        yield i, parent(res)
 
 
 if __name__ == "__main__":
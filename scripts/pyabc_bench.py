@@ -0,0 +1,276 @@
+"""
+Benchmarks of the hot paths of the pyabc bindings, on synthetic AIGs of configurable size.
+
+Run inside pyabc.exe, e.g. through the pyabc-bench build target, or directly:
+
+    pyabc.exe -c "python /path/to/scripts/pyabc_bench.py"
+
+Configuration is taken from the environment:
+
+    PYABC_BENCH_ANDS        number of AND nodes of the synthetic AIG (default 100000)
+    PYABC_BENCH_LATCHES     number of latches (default 1000)
+    PYABC_BENCH_PIS         number of PIs (default 1000)
+    PYABC_BENCH_POS         number of POs (default 1000)
+    PYABC_BENCH_CEXES       number of cexes in the cex vector (default 1000)
+    PYABC_BENCH_FORKS       number of processes per split_all batch (default 8)
+    PYABC_BENCH_MIN_TIME    minimal measured time per benchmark, in seconds (default 0.5)
+    PYABC_BENCH_OUTPUT      JSON file for the results (default: stdout)
+    PYABC_BENCH_BASELINE    JSON results of a previous run, to print the ratios against
+
+The results hold, for each benchmark, the number of iterations, the total time, and the time per
+operation in microseconds.
+"""
+
+import os
+import sys
+import json
+import time
+import array
+import random
+import socket
+import struct
+
+import _pyabc
+
+import pyabc.split
+
+
+def env_int(name, default):
+    return int(os.environ.get(name, default))
+
+
+params = dict(
+    ands=env_int('PYABC_BENCH_ANDS', 100000),
+    latches=env_int('PYABC_BENCH_LATCHES', 1000),
+    pis=env_int('PYABC_BENCH_PIS', 1000),
+    pos=env_int('PYABC_BENCH_POS', 1000),
+    cexes=env_int('PYABC_BENCH_CEXES', 1000),
+    forks=env_int('PYABC_BENCH_FORKS', 8),
+    min_time=float(os.environ.get('PYABC_BENCH_MIN_TIME', 0.5)),
+)
+
+results = {}
+
+
+def measure(name, f, min_time=None):
+    """ run f() in batches of doubling size until a batch takes at least min_time """
+
+    if min_time is None:
+        min_time = params['min_time']
+
+    n = 1
+
+    while True:
+
+        start = time.time()
+
+        for _ in xrange(n):
+            f()
+
+        elapsed = time.time() - start
+
+        if elapsed >= min_time:
+            break
+
+        n *= 2
+
+    results[name] = dict( iterations=n, seconds=elapsed, per_op_us=elapsed / n * 1e6 )
+
+
+def load_random_aig(n_pis, n_latches, n_ands, n_pos, seed=1):
+
+    rnd = random.Random(seed)
+
+    def random_lit(n_vars):
+        return 2 * rnd.randint(1, n_vars - 1) + rnd.randint(0, 1)
+
+    n_cis = 1 + n_pis + n_latches
+
+    fanin0 = array.array('i', [ random_lit(n_cis + i) for i in xrange(n_ands) ])
+    fanin1 = array.array('i', [ random_lit(n_cis + i) for i in xrange(n_ands) ])
+
+    n_vars = n_cis + n_ands
+
+    pos = array.array('i', [ random_lit(n_vars) for _ in xrange(n_pos) ])
+    latch_next = array.array('i', [ random_lit(n_vars) for _ in xrange(n_latches) ])
+
+    _pyabc.aig_from_arrays(n_pis, n_latches, fanin0, fanin1, pos, latch_next)
+
+
+def load_stuck_aig(n_pis, n_latches):
+
+    # latches that keep their initial 0 forever, and a PO that is the AND of all of them: a property
+    # that BMC cannot refute, so it reports every frame
+
+    fanin0 = array.array('i')
+    fanin1 = array.array('i')
+
+    lit = 2 * (1 + n_pis)
+
+    for i in xrange(1, n_latches):
+        fanin0.append(lit)
+        fanin1.append(2 * (1 + n_pis + i))
+        lit = 2 * (1 + n_pis + n_latches + i - 1)
+
+    latch_next = array.array('i', [ 2 * (1 + n_pis + i) for i in xrange(n_latches) ])
+
+    _pyabc.aig_from_arrays(n_pis, n_latches, fanin0, fanin1, array.array('i', [lit]), latch_next)
+
+
+def bench_run_command():
+
+    measure('run_command_empty', lambda: _pyabc.run_command(''))
+
+
+def bench_accessors():
+
+    for name in ('n_ands', 'n_pis', 'n_pos', 'n_latches', 'n_levels', 'prob_status', 'n_bmc_frames'):
+        measure('accessor_' + name, getattr(_pyabc, name))
+
+
+def bench_fingerprint():
+
+    measure('fingerprint_full', lambda: _pyabc.fingerprint())
+    measure('fingerprint_incremental', lambda: _pyabc.fingerprint(incremental=True))
+
+
+def make_cex(po, frames, n_regs, n_pis, rnd):
+
+    n_bits = n_regs + n_pis * frames
+    words = [ rnd.getrandbits(32) for _ in xrange( (n_bits + 31) // 32 ) ]
+
+    return _pyabc.cex_loads( struct.pack('=5i', po, frames - 1, n_regs, n_pis, n_bits) + struct.pack('=%dI'%len(words), *words) )
+
+
+def bench_cex_vector():
+
+    rnd = random.Random(1)
+
+    n_regs = _pyabc.n_latches()
+    n_pis = _pyabc.n_pis()
+
+    cexes = [ make_cex(i % _pyabc.n_pos(), 10, n_regs, n_pis, rnd) for i in xrange(params['cexes']) ]
+
+    _pyabc.cex_set_vector(cexes)
+
+    measure('cex_get_vector', _pyabc.cex_get_vector)
+    measure('cex_dumps', lambda: [ c.dumps() for c in cexes ])
+
+    _pyabc.cex_set_vector([])
+
+
+def bench_eq_classes():
+
+    n_pos = _pyabc.n_pos()
+    _pyabc.eq_classes_set( range(i, min(i + 8, n_pos)) for i in xrange(0, n_pos, 8) )
+
+    measure('eq_classes', _pyabc.eq_classes)
+
+    _pyabc.eq_classes_set(None)
+
+
+def bench_snapshot():
+
+    measure('snapshot_save', _pyabc.snapshot_save)
+
+    snapshot = _pyabc.snapshot_save()
+    measure('snapshot_restore', lambda: _pyabc.snapshot_restore(snapshot))
+
+    measure('abc_state_save', pyabc.split.abc_state)
+
+    state = pyabc.split.abc_state()
+    measure('abc_state_restore', state.restore)
+
+    measure('write_aiger_bytes', _pyabc.write_aiger_bytes)
+
+    aig = _pyabc.write_aiger_bytes()
+    measure('read_aiger_bytes', lambda: _pyabc.read_aiger_bytes(aig))
+
+    measure('aig_to_arrays', _pyabc.aig_to_arrays)
+
+
+def bench_split():
+
+    funcs = [ (lambda: 0, []) ] * params['forks']
+
+    def batch():
+        for _ in pyabc.split.split_all(funcs):
+            pass
+
+    measure('split_all_batch', batch)
+
+    results['split_all_batch']['processes'] = params['forks']
+
+
+def bench_frame_done():
+
+    load_stuck_aig(4, 64)
+
+    frames = [0]
+
+    def callback(frame, po, status):
+        frames[0] += 1
+
+    prev = _pyabc.set_frame_done_callback(callback)
+
+    start = time.time()
+    _pyabc.run_command('bmc3 -F 2000')
+    elapsed = time.time() - start
+
+    _pyabc.set_frame_done_callback(prev)
+
+    results['frame_done_callback'] = dict( iterations=frames[0], seconds=elapsed, per_op_us=elapsed / max(frames[0], 1) * 1e6 )
+
+
+def compare(baseline):
+
+    for name in sorted(results):
+
+        if name not in baseline:
+            continue
+
+        old = baseline[name]['per_op_us']
+        new = results[name]['per_op_us']
+
+        print >> sys.stderr, '%-28s %12.3f us %12.3f us %7.2fx'%( name, old, new, new / old if old else 0.0 )
+
+
+def main():
+
+    load_random_aig( params['pis'], params['latches'], params['ands'], params['pos'] )
+
+    bench_run_command()
+    bench_accessors()
+    bench_fingerprint()
+    bench_cex_vector()
+    bench_eq_classes()
+    bench_snapshot()
+    bench_split()
+    bench_frame_done()
+
+    report = dict(
+        version=1,
+        timestamp=time.time(),
+        host=socket.gethostname(),
+        allocator=_pyabc.allocator_name(),
+        params=params,
+        results=results,
+    )
+
+    output = os.environ.get('PYABC_BENCH_OUTPUT')
+
+    if output:
+        with open(output, 'w') as f:
+            json.dump(report, f, indent=1, sort_keys=True)
+    else:
+        json.dump(report, sys.stdout, indent=1, sort_keys=True)
+        print
+
+    baseline = os.environ.get('PYABC_BENCH_BASELINE')
+
+    if baseline:
+        with open(baseline, 'r') as f:
+            compare( json.load(f)['results'] )
+
+
+main()